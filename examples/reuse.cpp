@@ -6,9 +6,8 @@ static os_task_t idle_task;
 static uint32_t idle_stack[OS_STACK_MINIMUM_SIZE_WORDS];
 
 static void task_handler_idle(void *params) {
-    volatile uint32_t i = 0;
     while (true) {
-        i++;
+        os_stack_scan(OS_STACK_SCAN_WORDS);
     }
 }
 
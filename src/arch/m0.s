@@ -45,6 +45,10 @@ PendSV_Handler:
         .fnstart
         .cantunwind
 
+        /* Pick up any switch deferred by an IRQ, we return using a fixed
+           EXC_RETURN so losing lr is fine. */
+        bl      osi_pendsv
+
         /* Disable interrupts: */
         cpsid	i
 
@@ -165,16 +169,31 @@ SVC_Handler:
         mrs       r0, psp                         /* read psp */
         ldr       r1, [r0, #24]                   /* read saved pc from stack */
         subs      r1, r1, #2                      /* point to svc instruction */
-
-        // No user defined SVC's for now.
-        // ldrb    r1, [r1]                       /* load svc number */
-        // cmp     r1, #0
-        // bne     svc_user                       /* user svc number > 0 */
-
-        mov       lr, r4
-        ldmia     r0, {r0 - r3, r4}               /* read r0 - r3, r12 from stack */
-        mov       r12, r4
-        mov       r4, lr
+        ldrb      r1, [r1]                        /* load svc number */
+
+        ldr       r2, =osi_svc_table
+        ldr       r3, =osi_svc_table_size
+        cmp       r1, #OS_SVC_USER                /* user svc? */
+        blo       svc_lookup
+        subs      r1, r1, #OS_SVC_USER
+        ldr       r2, =osi_svc_user_table
+        ldr       r3, =osi_svc_user_table_size
+
+svc_lookup:
+        ldr       r3, [r3]
+        cmp       r1, r3                          /* out of range? */
+        bhs       svc_invalid
+        lsls      r1, r1, #2
+        ldr       r1, [r2, r1]                    /* load svc function */
+        cmp       r1, #0                          /* unused entry? */
+        bne       svc_call
+
+svc_invalid:
+        ldr       r1, =osi_svc_invalid
+
+svc_call:
+        mov       r12, r1
+        ldmia     r0, {r0 - r3}                   /* read r0 - r3 from stack */
         blx       r12                             /* call svc function */
 
         mrs       r3, psp                         /* read psp */
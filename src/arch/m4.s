@@ -40,6 +40,11 @@ PendSV_Handler:
         .fnstart
         .cantunwind
 
+        /* Pick up any switch deferred by an IRQ. */
+        push     {r0, lr}
+        bl       osi_pendsv
+        pop      {r0, lr}
+
         /* Check to see if we're switching to the same task. */
         ldr      r3, =osg
         ldr      r1, [r3, #OSG_RUNNING]
@@ -107,12 +112,29 @@ SVC_Handler:
 
         mrs       r0, psp                         /* read psp */
         ldr       r1, [r0, #24]                   /* read saved pc from stack */
-
-        // No user defined SVC's for now.
-        // ldrb      r1, [r1, #-2]                /* load svc number */
-        // cbnz      r1, svc_user
-
-        ldm       r0, {r0 - r3, r12}
+        ldrb      r1, [r1, #-2]                   /* load svc number */
+
+        ldr       r2, =osi_svc_table
+        ldr       r3, =osi_svc_table_size
+        cmp       r1, #OS_SVC_USER                /* user svc? */
+        blo       svc_lookup
+        sub       r1, r1, #OS_SVC_USER
+        ldr       r2, =osi_svc_user_table
+        ldr       r3, =osi_svc_user_table_size
+
+svc_lookup:
+        ldr       r3, [r3]
+        cmp       r1, r3                          /* out of range? */
+        bhs       svc_invalid
+        ldr       r12, [r2, r1, lsl #2]           /* load svc function */
+        cmp       r12, #0                         /* unused entry? */
+        bne       svc_call
+
+svc_invalid:
+        ldr       r12, =osi_svc_invalid
+
+svc_call:
+        ldm       r0, {r0 - r3}
         push      {r4, lr}                        /* save EXC_RETURN */
         blx       r12                             /* call svc function */
         pop       {r4, lr}                        /* restore EXC_RETURN */
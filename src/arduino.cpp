@@ -21,30 +21,39 @@
 
 extern "C" {
 
-static void serial_putchar(char c, void *arg) {
-    if (c != 0) {
+/**
+ * Size of the stack buffer used to batch printf output.
+ */
+#define OS_PRINTF_CHUNK_SIZE (64)
+
+static void serial_write(const char *chunk, size_t size, void *arg) {
 #if defined(OS_CONFIG_DEBUG_RTT)
-        SEGGER_RTT_PutChar(0, c);
+    SEGGER_RTT_Write(0, chunk, size);
 #else
-        Serial.print(c);
+    Serial.write(chunk, size);
 #endif
-    }
 }
 
 uint32_t osi_printf(const char *f, ...) {
     va_list args;
     va_start(args, f);
-    auto i = os_vfctprintf(serial_putchar, NULL, f, args);
+    auto i = osi_vprintf(f, args);
     va_end(args);
     return i;
 }
 
 uint32_t osi_vprintf(const char *f, va_list args) {
-    auto i = os_vfctprintf(serial_putchar, NULL, f, args);
+    char buffer[OS_PRINTF_CHUNK_SIZE];
+    auto i = os_vchunkprintf(serial_write, NULL, buffer, sizeof(buffer), f, args);
     return i;
 }
 
 os_status_t osi_platform_setup() {
+#if defined(__SAMD51__)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
     return OSS_SUCCESS;
 }
 
@@ -61,6 +70,78 @@ uint32_t osi_platform_micros() {
     return micros();
 }
 
+uint32_t osi_platform_cycles() {
+#if defined(__SAMD51__)
+    return DWT->CYCCNT;
+#else
+    // The M0+ has no cycle counter.
+    return micros() * (SystemCoreClock / 1000000);
+#endif
+}
+
+#if defined(OS_CONFIG_CRASH_SNAPSHOT)
+
+void osi_platform_crash_saved(os_crash_snapshot_t *snapshot) {
+}
+
+#endif
+
+#if defined(OS_CONFIG_WATCHDOG)
+
+/**
+ * The WDT counts a 1.024kHz clock and PER picks a timeout of 8 << PER
+ * cycles, so each step is roughly 8ms doubled.
+ */
+static uint8_t watchdog_period(uint32_t timeout) {
+    uint8_t per = 0;
+    while (per < 11 && (8u << per) < timeout) {
+        per++;
+    }
+    return per;
+}
+
+os_status_t osi_platform_watchdog_start(uint32_t timeout) {
+#if defined(__SAMD51__)
+    WDT->CTRLA.reg = 0;
+    while (WDT->SYNCBUSY.reg) {
+    }
+    WDT->CONFIG.bit.PER = watchdog_period(timeout);
+    WDT->CTRLA.bit.ENABLE = 1;
+    while (WDT->SYNCBUSY.reg) {
+    }
+#elif defined(__SAMD21__)
+    // Generic clock 2 divides the 32kHz ULP oscillator by 32.
+    GCLK->GENDIV.reg = GCLK_GENDIV_ID(2) | GCLK_GENDIV_DIV(4);
+    GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(2) | GCLK_GENCTRL_GENEN | GCLK_GENCTRL_SRC_OSCULP32K | GCLK_GENCTRL_DIVSEL;
+    while (GCLK->STATUS.bit.SYNCBUSY) {
+    }
+    GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID_WDT | GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK2;
+    WDT->CTRL.reg = 0;
+    while (WDT->STATUS.bit.SYNCBUSY) {
+    }
+    WDT->CONFIG.bit.PER = watchdog_period(timeout);
+    WDT->CTRL.bit.ENABLE = 1;
+    while (WDT->STATUS.bit.SYNCBUSY) {
+    }
+#endif
+    return OSS_SUCCESS;
+}
+
+void osi_platform_watchdog_feed() {
+#if defined(__SAMD51__)
+    // Writing again while the last clear is syncing resets immediately.
+    if (!WDT->SYNCBUSY.bit.CLEAR) {
+        WDT->CLEAR.reg = WDT_CLEAR_CLEAR_KEY;
+    }
+#elif defined(__SAMD21__)
+    if (!WDT->STATUS.bit.SYNCBUSY) {
+        WDT->CLEAR.reg = WDT_CLEAR_CLEAR_KEY;
+    }
+#endif
+}
+
+#endif
+
 extern void SysTick_DefaultHandler(void);
 
 int32_t sysTickHook(void) {
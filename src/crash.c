@@ -0,0 +1,193 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "internal.h"
+
+#if defined(OS_CONFIG_CRASH_SNAPSHOT)
+
+/**
+ * Startup code only zeroes .bss, so this survives a reset.
+ */
+static os_crash_snapshot_t crash __attribute__((section(".noinit")));
+
+static uint32_t checksum(os_crash_snapshot_t *snapshot) {
+    uint32_t sum = 0x811c9dc5;
+    const uint8_t *bytes = (const uint8_t *)snapshot;
+    for (size_t i = 0; i < offsetof(os_crash_snapshot_t, checksum); ++i) {
+        sum = (sum ^ bytes[i]) * 0x01000193;
+    }
+    return sum;
+}
+
+/**
+ * Names are copied because the pointers mean nothing once different firmware
+ * is running. The snapshot was zeroed so the copy is always terminated.
+ */
+static void copy_name(char *dst, const char *src) {
+    for (uint32_t i = 0; src != NULL && src[i] != 0 && i < OS_CRASH_NAME_MAX - 1; ++i) {
+        dst[i] = src[i];
+    }
+}
+
+static void copy_task_name(char *dst, os_task_t *task) {
+    if (task != NULL) {
+        copy_name(dst, task->name);
+    }
+}
+
+static void capture_lock(const char *name, os_task_t *owner, uint8_t kind) {
+    if (owner == NULL || crash.nlocks == OS_CRASH_LOCKS_MAX) {
+        return;
+    }
+    os_crash_lock_t *lock = &crash.locks[crash.nlocks++];
+    copy_name(lock->name, name);
+    copy_name(lock->owner, owner->name);
+    lock->kind = kind;
+}
+
+void osi_crash_capture(uint32_t kind, uintptr_t *stack, uint32_t lr, cortex_hard_fault_t *hfr) {
+    memset(&crash, 0, sizeof(crash));
+
+    crash.magic = OS_CRASH_MAGIC;
+    crash.kind = kind;
+    crash.uptime = os_uptime();
+    copy_task_name(crash.running, (os_task_t *)osg.running);
+#if defined(OS_CONFIG_WATCHDOG)
+    if (osg.watchdog_overdue != NULL) {
+        copy_task_name(crash.watchdog, osg.watchdog_overdue->task);
+    }
+#endif
+
+    if (hfr != NULL) {
+        crash.fault.r0 = (uint32_t)(uintptr_t)hfr->registers.R0;
+        crash.fault.r1 = (uint32_t)(uintptr_t)hfr->registers.R1;
+        crash.fault.r2 = (uint32_t)(uintptr_t)hfr->registers.R2;
+        crash.fault.r3 = (uint32_t)(uintptr_t)hfr->registers.R3;
+        crash.fault.r12 = (uint32_t)(uintptr_t)hfr->registers.R12;
+        crash.fault.lr = (uint32_t)(uintptr_t)hfr->registers.LR;
+        crash.fault.pc = (uint32_t)(uintptr_t)hfr->registers.PC;
+        crash.fault.psr = hfr->registers.psr.byte;
+        crash.fault.exc_return = lr;
+        crash.fault.shcsr = hfr->syshndctrl.byte;
+        crash.fault.mfsr = hfr->mfsr.byte;
+        crash.fault.bfsr = hfr->bfsr.byte;
+        crash.fault.ufsr = hfr->ufsr.byte;
+        crash.fault.hfsr = hfr->hfsr.byte;
+        crash.fault.dfsr = hfr->dfsr.byte;
+        crash.fault.bfar = hfr->bfar;
+        crash.fault.afsr = hfr->afsr;
+    }
+
+    for (os_task_t *iter = osg.tasks; iter != NULL && crash.ntasks < OS_CRASH_TASKS_MAX; iter = iter->np) {
+        os_crash_task_t *task = &crash.tasks[crash.ntasks++];
+        copy_name(task->name, iter->name);
+        task->sp = (uint32_t)(uintptr_t)iter->sp;
+        task->status = iter->status;
+        task->priority = iter->priority;
+        if (iter->sp != NULL) {
+            uint32_t *regs = osi_task_return_regs(iter);
+            task->lr = regs[5];
+            task->pc = regs[6];
+        }
+        if (iter == osg.running && hfr != NULL) {
+            task->sp = (uint32_t)(uintptr_t)stack;
+            task->lr = crash.fault.lr;
+            task->pc = crash.fault.pc;
+        }
+    }
+
+    for (os_mutex_t *iter = os_mutex_iterate(NULL); iter != NULL; iter = os_mutex_iterate(iter)) {
+        capture_lock(iter->def->name, iter->owner, OS_LOCK_KIND_MUTEX);
+    }
+    for (os_rwlock_t *iter = os_rwlock_iterate(NULL); iter != NULL; iter = os_rwlock_iterate(iter)) {
+        capture_lock(iter->def->name, iter->writer, OS_LOCK_KIND_RWLOCK);
+    }
+
+#if defined(OS_CONFIG_TRACE)
+    crash.nevents = osi_trace_recent(crash.events, OS_CRASH_EVENTS_MAX);
+#endif
+
+    crash.checksum = checksum(&crash);
+
+    osi_platform_crash_saved(&crash);
+}
+
+os_crash_snapshot_t *os_crash_snapshot() {
+    if (crash.magic != OS_CRASH_MAGIC || crash.checksum != checksum(&crash)) {
+        return NULL;
+    }
+    return &crash;
+}
+
+os_status_t os_crash_clear() {
+    crash.magic = 0;
+    return OSS_SUCCESS;
+}
+
+static const char *or_unknown(const char *name) {
+    return name[0] != 0 ? name : "?";
+}
+
+#define CRASH_LINE(...)                                                                                                                    \
+    os_snprintf(buffer, sizeof(buffer), __VA_ARGS__);                                                                                      \
+    line(buffer, arg)
+
+os_status_t osi_crash_format(os_crash_snapshot_t *snapshot, void (*line)(const char *line, void *arg), void *arg) {
+    char buffer[96];
+
+    if (snapshot->kind == OS_CRASH_HARD_FAULT) {
+        CRASH_LINE("crash: hard fault at %u ms in '%s'\n", snapshot->uptime, or_unknown(snapshot->running));
+        os_crash_fault_t *f = &snapshot->fault;
+        CRASH_LINE("  pc=%08x lr=%08x psr=%08x exc=%08x\n", f->pc, f->lr, f->psr, f->exc_return);
+        CRASH_LINE("  r0=%08x r1=%08x r2=%08x r3=%08x r12=%08x\n", f->r0, f->r1, f->r2, f->r3, f->r12);
+        CRASH_LINE("  shcsr=%08x mfsr=%02x bfsr=%02x ufsr=%04x hfsr=%08x\n", f->shcsr, f->mfsr, f->bfsr, f->ufsr, f->hfsr);
+        CRASH_LINE("  dfsr=%08x bfar=%08x afsr=%08x\n", f->dfsr, f->bfar, f->afsr);
+    } else {
+        CRASH_LINE("crash: %s at %u ms in '%s'\n", os_panic_kind_str((os_panic_kind_t)snapshot->kind), snapshot->uptime,
+                   or_unknown(snapshot->running));
+    }
+
+    if (snapshot->watchdog[0] != 0) {
+        CRASH_LINE("  watchdog: '%s' missed its check-in\n", snapshot->watchdog);
+    }
+
+    for (uint32_t i = 0; i < snapshot->ntasks; ++i) {
+        os_crash_task_t *task = &snapshot->tasks[i];
+        CRASH_LINE("  task '%s' %s prio=%d sp=%08x pc=%08x lr=%08x\n", or_unknown(task->name),
+                   os_task_status_str((os_task_status)task->status), task->priority, task->sp, task->pc, task->lr);
+    }
+
+    for (uint32_t i = 0; i < snapshot->nlocks; ++i) {
+        os_crash_lock_t *lock = &snapshot->locks[i];
+        CRASH_LINE("  %s '%s' held by '%s'\n", lock->kind == OS_LOCK_KIND_MUTEX ? "mutex" : "rwlock", or_unknown(lock->name),
+                   or_unknown(lock->owner));
+    }
+
+    for (uint32_t i = 0; i < snapshot->nevents; ++i) {
+        os_trace_recent_t *event = &snapshot->events[i];
+        CRASH_LINE("  event %u us: %u (%08x)\n", event->time, event->event, event->value);
+    }
+
+    return OSS_SUCCESS;
+}
+
+static void dump_line(const char *line, void *arg) {
+    osi_printf("%s", line);
+}
+
+os_status_t os_crash_dump(os_crash_snapshot_t *snapshot) {
+    return osi_crash_format(snapshot, dump_line, NULL);
+}
+
+#endif
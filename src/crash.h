@@ -0,0 +1,117 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_CRASH_H
+#define OS_CRASH_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define OS_CRASH_MAGIC      (0x43525348)
+#define OS_CRASH_TASKS_MAX  (8)
+#define OS_CRASH_LOCKS_MAX  (8)
+#define OS_CRASH_EVENTS_MAX (16)
+#define OS_CRASH_NAME_MAX   (16)
+
+/**
+ * Kind is an os_panic_kind_t, or this for hard faults.
+ */
+#define OS_CRASH_HARD_FAULT (0xff)
+
+/**
+ * Names are copied, truncated to OS_CRASH_NAME_MAX - 1 characters, so they
+ * still read right after the firmware changes. PC and LR are from the task's
+ * stacked frame, which for the running task is from its last switch unless
+ * this was a hard fault.
+ */
+typedef struct os_crash_task_t {
+    char name[OS_CRASH_NAME_MAX];
+    uint32_t sp;
+    uint32_t pc;
+    uint32_t lr;
+    uint8_t status;
+    uint8_t priority;
+} os_crash_task_t;
+
+typedef struct os_crash_lock_t {
+    char name[OS_CRASH_NAME_MAX];
+    char owner[OS_CRASH_NAME_MAX];
+    uint8_t kind;
+} os_crash_lock_t;
+
+typedef struct os_crash_fault_t {
+    uint32_t r0, r1, r2, r3, r12, lr, pc, psr;
+    uint32_t exc_return;
+    uint32_t shcsr;
+    uint8_t mfsr;
+    uint8_t bfsr;
+    uint16_t ufsr;
+    uint32_t hfsr;
+    uint32_t dfsr;
+    uint32_t bfar;
+    uint32_t afsr;
+} os_crash_fault_t;
+
+typedef struct os_crash_snapshot_t {
+    uint32_t magic;
+    uint32_t kind;
+    uint32_t uptime;
+    char running[OS_CRASH_NAME_MAX];
+    char watchdog[OS_CRASH_NAME_MAX]; //! Task that missed its watchdog check-in. */
+    os_crash_fault_t fault;
+    uint8_t ntasks;
+    uint8_t nlocks;
+    uint8_t nevents;
+    os_crash_task_t tasks[OS_CRASH_TASKS_MAX];
+    os_crash_lock_t locks[OS_CRASH_LOCKS_MAX];
+    os_trace_recent_t events[OS_CRASH_EVENTS_MAX];
+    uint32_t checksum;
+} os_crash_snapshot_t;
+
+#if defined(OS_CONFIG_CRASH_SNAPSHOT)
+
+/**
+ * The snapshot left by the last crash, or NULL if the last reset wasn't a
+ * crash or RAM didn't survive it.
+ */
+os_crash_snapshot_t *os_crash_snapshot();
+
+/**
+ * Print the snapshot using osi_printf so this goes out over RTT when
+ * OS_CONFIG_DEBUG_RTT is enabled.
+ */
+os_status_t os_crash_dump(os_crash_snapshot_t *snapshot);
+
+/**
+ * Forget the snapshot, call after it's been reported.
+ */
+os_status_t os_crash_clear();
+
+/**
+ * Format the snapshot a line at a time.
+ */
+os_status_t osi_crash_format(os_crash_snapshot_t *snapshot, void (*line)(const char *line, void *arg), void *arg);
+
+/**
+ * Record the snapshot, stack, lr and hfr are only for hard faults.
+ */
+void osi_crash_capture(uint32_t kind, uintptr_t *stack, uint32_t lr, cortex_hard_fault_t *hfr);
+
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -22,6 +22,7 @@
 #define NVIC_UFSR   (*(volatile unsigned short *)(0xE000ED2Au)) // Usage Fault Status Register
 #define NVIC_HFSR   (*(volatile unsigned int *)(0xE000ED2Cu))   // Hard Fault Status Register
 #define NVIC_DFSR   (*(volatile unsigned int *)(0xE000ED30u))   // Debug Fault Status Register
+#define NVIC_MMFAR  (*(volatile unsigned int *)(0xE000ED34u))   // Memory Management Fault Address Register
 #define NVIC_BFAR   (*(volatile unsigned int *)(0xE000ED38u))   // Bus Fault Manage Address Register
 #define NVIC_AFSR   (*(volatile unsigned int *)(0xE000ED3Cu))   // Auxiliary Fault Status Register
 
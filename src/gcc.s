@@ -21,6 +21,8 @@
 .equ    OSG_RUNNING, 0
 .equ    OSG_SCHEDULED, 4
 
+.equ    OS_SVC_USER, 128
+
 .section ".text"
 .align  2
 
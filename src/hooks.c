@@ -24,7 +24,7 @@ extern void NVIC_SystemReset(void);
 
 void osi_assert(const char *assertion, const char *file, int line) {
     osi_printf("\n\nassertion \"%s\" failed: file \"%s\", line %d\n", assertion, file, line);
-    osi_panic(OS_PANIC_ASSERTION);
+    osi_crash(OS_PANIC_ASSERTION);
 }
 
 #endif // defined(__SAMD21__) || defined(__SAMD51__)
@@ -45,6 +45,9 @@ void osi_panic(os_panic_kind_t code) {
         osi_printf("  '%s' status(%s) (0x%x)\n", iter->name, os_task_status_str(iter->status), iter->priority);
     }
 
+    osi_printf("\nobjects:\n");
+    os_objects_dump();
+
 #if defined(__SAMD21__) || defined(__SAMD51__)
     NVIC_SystemReset();
 #endif // defined(__SAMD21__) || defined(__SAMD51__)
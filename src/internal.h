@@ -44,6 +44,12 @@ extern "C" {
  */
 void osi_panic(os_panic_kind_t code);
 
+/**
+ * Record the crash snapshot, when enabled, and then invoke the osi_panic
+ * hook. The kernel panics through this so custom hooks still get a snapshot.
+ */
+void osi_crash(os_panic_kind_t code);
+
 void osi_debug_dump(os_panic_kind_t code);
 
 /**
@@ -63,6 +69,33 @@ os_status_t osi_dispatch(os_task_t *task);
 
 os_status_t osi_dispatch_or_queue(os_task_t *task);
 
+/**
+ * Make a task woken from an IRQ runnable and request a PendSV. Any number of
+ * these in a single IRQ cause at most one task switch.
+ */
+os_status_t osi_dispatch_isr(os_task_t *task);
+
+/**
+ * Do any switch that was deferred because of an IRQ or the scheduler lock.
+ */
+os_status_t osi_reschedule();
+
+/**
+ * Called from PendSV to do the switch deferred by osi_dispatch_isr.
+ */
+void osi_pendsv();
+
+/**
+ * Indexed by SVC number from SVC_Handler, empty and out of range entries go
+ * to osi_svc_invalid.
+ */
+extern const os_svc_handler_t osi_svc_table[];
+extern const uint32_t osi_svc_table_size;
+extern os_svc_handler_t osi_svc_user_table[];
+extern const uint32_t osi_svc_user_table_size;
+
+uint32_t osi_svc_invalid(void);
+
 /**
  *
  */
@@ -73,6 +106,11 @@ os_status_t osi_schedule();
  */
 os_status_t osi_task_status_set(os_task_t *task, os_task_status new_status);
 
+/**
+ * Release every mutex and rwlock a task that's stopped running still holds.
+ */
+os_status_t osi_task_abandon_locks(os_task_t *task);
+
 /**
  *
  */
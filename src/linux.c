@@ -14,6 +14,7 @@
 #if !defined(ARDUINO)
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 #include "os.h"
@@ -52,9 +53,63 @@ uint32_t osi_platform_delay(uint32_t ms) {
 }
 
 uint32_t osi_platform_micros() {
+    return linux_uptime * 1000;
+}
+
+uint32_t osi_platform_cycles() {
     return 0;
 }
 
+#if defined(OS_CONFIG_CRASH_SNAPSHOT)
+
+static void crash_line(const char *line, void *arg) {
+    fputs(line, (FILE *)arg);
+}
+
+/**
+ * There's no RAM that survives here, so the snapshot goes to a file,
+ * OS_CRASH_FILE in the environment or osh-crash.txt.
+ */
+void osi_platform_crash_saved(os_crash_snapshot_t *snapshot) {
+    const char *path = getenv("OS_CRASH_FILE");
+    FILE *fp = fopen(path != NULL ? path : "osh-crash.txt", "w");
+    if (fp == NULL) {
+        return;
+    }
+    osi_crash_format(snapshot, crash_line, fp);
+    fclose(fp);
+}
+
+#endif
+
+#if defined(OS_CONFIG_WATCHDOG)
+
+static uint32_t watchdog_timeout = 0;
+static uint32_t watchdog_fed = 0;
+static uint32_t watchdog_feeds = 0;
+
+os_status_t osi_platform_watchdog_start(uint32_t timeout) {
+    watchdog_timeout = timeout;
+    watchdog_fed = linux_uptime;
+    watchdog_feeds = 0;
+    return OSS_SUCCESS;
+}
+
+void osi_platform_watchdog_feed() {
+    watchdog_fed = linux_uptime;
+    watchdog_feeds++;
+}
+
+uint32_t tests_watchdog_feeds() {
+    return watchdog_feeds;
+}
+
+bool tests_watchdog_expired() {
+    return watchdog_timeout > 0 && linux_uptime - watchdog_fed > watchdog_timeout;
+}
+
+#endif
+
 void __disable_irq() {
 }
 
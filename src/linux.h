@@ -25,6 +25,35 @@ extern "C" {
  */
 uint32_t tests_platform_time(uint32_t time);
 
+/**
+ * Take binary log bytes written by os_log, stands in for the RTT channel.
+ */
+uint32_t tests_log_read(void *buffer, uint32_t size);
+
+/**
+ * Take event stream bytes written when OS_CONFIG_TRACE is on.
+ */
+uint32_t tests_trace_read(void *buffer, uint32_t size);
+
+/**
+ * Type into the shell, stands in for the RTT down channel.
+ */
+uint32_t tests_shell_write(const char *buffer, uint32_t size);
+
+#if defined(OS_CONFIG_WATCHDOG)
+
+/**
+ * Times the fake watchdog has been fed since it was started.
+ */
+uint32_t tests_watchdog_feeds();
+
+/**
+ * Whether hardware would have reset by now.
+ */
+bool tests_watchdog_expired();
+
+#endif
+
 void __disable_irq();
 
 void __enable_irq();
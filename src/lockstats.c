@@ -0,0 +1,165 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stddef.h>
+
+#include "os.h"
+#include "internal.h"
+
+#if defined(OS_CONFIG_LOCK_STATS)
+
+static const char *kind_names[] = { "mutex", "semaphore", "rwlock" };
+
+static void clear(os_lock_stats_t *stats) {
+    stats->acquisitions = 0;
+    stats->contended = 0;
+    stats->timeouts = 0;
+    stats->wait_total = 0;
+    stats->wait_max = 0;
+    stats->hold_total = 0;
+    stats->hold_max = 0;
+    stats->worst_owner = NULL;
+}
+
+static void record_wait(os_lock_stats_t *stats, os_task_t *task) {
+    uint32_t waited = os_micros() - task->blocked_since;
+    stats->wait_total += waited;
+    if (waited > stats->wait_max) {
+        stats->wait_max = waited;
+    }
+}
+
+void osi_lock_stats_created(os_lock_stats_t *stats, const char *name, uint8_t kind) {
+    clear(stats);
+    stats->name = name;
+    stats->kind = kind;
+    stats->holder = NULL;
+    stats->held_since = 0;
+}
+
+void osi_lock_stats_acquired(os_lock_stats_t *stats) {
+    stats->acquisitions++;
+}
+
+void osi_lock_stats_blocked(os_lock_stats_t *stats, os_task_t *task) {
+    stats->contended++;
+    task->blocked_since = os_micros();
+}
+
+void osi_lock_stats_woken(os_lock_stats_t *stats, os_task_t *task) {
+    stats->acquisitions++;
+    record_wait(stats, task);
+}
+
+void osi_lock_stats_timeout(os_lock_stats_t *stats, os_task_t *task) {
+    stats->timeouts++;
+    record_wait(stats, task);
+}
+
+void osi_lock_stats_held(os_lock_stats_t *stats, os_task_t *task) {
+    stats->holder = task;
+    stats->held_since = os_micros();
+}
+
+void osi_lock_stats_released(os_lock_stats_t *stats) {
+    if (stats->holder == NULL) {
+        return;
+    }
+
+    uint32_t held = os_micros() - stats->held_since;
+    stats->hold_total += held;
+    if (held > stats->hold_max || stats->worst_owner == NULL) {
+        stats->hold_max = held;
+        stats->worst_owner = stats->holder;
+    }
+    stats->holder = NULL;
+}
+
+/**
+ * The stats live in the locks, so walk the mutex, semaphore and rwlock
+ * registries in that order.
+ */
+static os_lock_stats_t *first_of_kind(uint8_t kind) {
+    switch (kind) {
+    case OS_LOCK_KIND_MUTEX:
+        if (osg.mutexes != NULL) {
+            return &osg.mutexes->stats;
+        }
+        // fall through
+    case OS_LOCK_KIND_SEMAPHORE:
+        if (osg.semaphores != NULL) {
+            return &osg.semaphores->stats;
+        }
+        // fall through
+    case OS_LOCK_KIND_RWLOCK:
+        if (osg.rwlocks != NULL) {
+            return &osg.rwlocks->stats;
+        }
+    }
+    return NULL;
+}
+
+#define LOCK_OF(s, type) ((type *)((uint8_t *)(s)-offsetof(type, stats)))
+
+os_lock_stats_t *os_lock_stats_iterate(os_lock_stats_t *iter) {
+    if (iter == NULL) {
+        return first_of_kind(OS_LOCK_KIND_MUTEX);
+    }
+
+    switch (iter->kind) {
+    case OS_LOCK_KIND_MUTEX: {
+        os_mutex_t *next = LOCK_OF(iter, os_mutex_t)->next;
+        return next != NULL ? &next->stats : first_of_kind(OS_LOCK_KIND_SEMAPHORE);
+    }
+    case OS_LOCK_KIND_SEMAPHORE: {
+        os_semaphore_t *next = LOCK_OF(iter, os_semaphore_t)->next;
+        return next != NULL ? &next->stats : first_of_kind(OS_LOCK_KIND_RWLOCK);
+    }
+    case OS_LOCK_KIND_RWLOCK: {
+        os_rwlock_t *next = LOCK_OF(iter, os_rwlock_t)->next;
+        return next != NULL ? &next->stats : NULL;
+    }
+    }
+
+    return NULL;
+}
+
+os_status_t os_lock_stats_reset() {
+    OS_LOCK();
+    for (os_lock_stats_t *iter = os_lock_stats_iterate(NULL); iter != NULL; iter = os_lock_stats_iterate(iter)) {
+        clear(iter);
+    }
+    OS_UNLOCK();
+
+    return OSS_SUCCESS;
+}
+
+os_status_t os_lock_stats_dump() {
+    for (os_lock_stats_t *iter = os_lock_stats_iterate(NULL); iter != NULL; iter = os_lock_stats_iterate(iter)) {
+        if (iter->acquisitions == 0 && iter->timeouts == 0) {
+            continue;
+        }
+
+        uint32_t waits = iter->contended > 0 ? iter->contended : 1;
+        osi_printf("%s %s: acquired=%u contended=%u timeouts=%u wait avg=%uus max=%uus\n", kind_names[iter->kind],
+                   iter->name != NULL ? iter->name : "<unnamed>", iter->acquisitions, iter->contended, iter->timeouts,
+                   (uint32_t)(iter->wait_total / waits), iter->wait_max);
+        if (iter->worst_owner != NULL) {
+            osi_printf("  hold total=%uus max=%uus by %s\n", (uint32_t)iter->hold_total, iter->hold_max, iter->worst_owner->name);
+        }
+    }
+
+    return OSS_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_LOCKSTATS_H
+#define OS_LOCKSTATS_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#if defined(OS_CONFIG_LOCK_STATS)
+
+/**
+ * Walk every mutex, semaphore and rwlock that's been created, pass NULL to
+ * get the first and NULL is returned after the last.
+ */
+os_lock_stats_t *os_lock_stats_iterate(os_lock_stats_t *iter);
+
+/**
+ *
+ */
+os_status_t os_lock_stats_reset();
+
+/**
+ * Print every lock that's been acquired, using osi_printf so this goes out
+ * over RTT when OS_CONFIG_DEBUG_RTT is enabled.
+ */
+os_status_t os_lock_stats_dump();
+
+void osi_lock_stats_created(os_lock_stats_t *stats, const char *name, uint8_t kind);
+void osi_lock_stats_acquired(os_lock_stats_t *stats);
+void osi_lock_stats_blocked(os_lock_stats_t *stats, os_task_t *task);
+void osi_lock_stats_woken(os_lock_stats_t *stats, os_task_t *task);
+void osi_lock_stats_timeout(os_lock_stats_t *stats, os_task_t *task);
+void osi_lock_stats_held(os_lock_stats_t *stats, os_task_t *task);
+void osi_lock_stats_released(os_lock_stats_t *stats);
+
+#define OS_LOCK_STATS_CREATED(stats, name, kind) osi_lock_stats_created(stats, name, kind)
+#define OS_LOCK_STATS_ACQUIRED(stats)            osi_lock_stats_acquired(stats)
+#define OS_LOCK_STATS_BLOCKED(stats, task)       osi_lock_stats_blocked(stats, task)
+#define OS_LOCK_STATS_WOKEN(stats, task)         osi_lock_stats_woken(stats, task)
+#define OS_LOCK_STATS_TIMEOUT(stats, task)       osi_lock_stats_timeout(stats, task)
+#define OS_LOCK_STATS_HELD(stats, task)          osi_lock_stats_held(stats, task)
+#define OS_LOCK_STATS_RELEASED(stats)            osi_lock_stats_released(stats)
+
+#else
+
+#define OS_LOCK_STATS_CREATED(stats, name, kind)
+#define OS_LOCK_STATS_ACQUIRED(stats)
+#define OS_LOCK_STATS_BLOCKED(stats, task)
+#define OS_LOCK_STATS_WOKEN(stats, task)
+#define OS_LOCK_STATS_TIMEOUT(stats, task)
+#define OS_LOCK_STATS_HELD(stats, task)
+#define OS_LOCK_STATS_RELEASED(stats)
+
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
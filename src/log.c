@@ -0,0 +1,91 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "internal.h"
+
+static uint32_t log_dropped = 0;
+
+#if defined(ARDUINO)
+
+static uint8_t log_buffer[OS_LOG_BUFFER_SIZE];
+
+os_status_t os_log_initialize() {
+    if (SEGGER_RTT_ConfigUpBuffer(OS_LOG_RTT_CHANNEL, "oslog", log_buffer, sizeof(log_buffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP) < 0) {
+        return OSS_ERROR_INVALID;
+    }
+    return OSS_SUCCESS;
+}
+
+static bool log_append(const void *record, uint32_t size) {
+    // Skip mode writes all or nothing, so records never get split.
+    return SEGGER_RTT_Write(OS_LOG_RTT_CHANNEL, record, size) == size;
+}
+
+#else
+
+static uint8_t log_buffer[OS_LOG_BUFFER_SIZE];
+static uint32_t log_head = 0;
+static uint32_t log_tail = 0;
+
+os_status_t os_log_initialize() {
+    log_head = 0;
+    log_tail = 0;
+    log_dropped = 0;
+    return OSS_SUCCESS;
+}
+
+static bool log_append(const void *record, uint32_t size) {
+    uint32_t used = log_head - log_tail;
+    if (sizeof(log_buffer) - used < size) {
+        return false;
+    }
+    for (uint32_t i = 0; i < size; ++i) {
+        log_buffer[(log_head + i) % sizeof(log_buffer)] = ((const uint8_t *)record)[i];
+    }
+    log_head += size;
+    return true;
+}
+
+uint32_t tests_log_read(void *buffer, uint32_t size) {
+    uint32_t read = 0;
+    for (; read < size && log_tail != log_head; ++read, ++log_tail) {
+        ((uint8_t *)buffer)[read] = log_buffer[log_tail % sizeof(log_buffer)];
+    }
+    return read;
+}
+
+#endif
+
+os_status_t os_log_write(const char *format, const uint32_t *args, uint32_t nargs) {
+    uint32_t record[2 + OS_LOG_ARGS_MAX];
+
+    if (nargs > OS_LOG_ARGS_MAX) {
+        return OSS_ERROR_INVALID;
+    }
+
+    record[0] = (uint32_t)(uintptr_t)format;
+    record[1] = os_micros();
+    memcpy(&record[2], args, nargs * sizeof(uint32_t));
+
+    if (!log_append(record, (2 + nargs) * sizeof(uint32_t))) {
+        log_dropped++;
+        return OSS_ERROR_MEM;
+    }
+
+    return OSS_SUCCESS;
+}
+
+uint32_t os_log_dropped() {
+    return log_dropped;
+}
@@ -0,0 +1,103 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_LOG_H
+#define OS_LOG_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * RTT up channel the binary log is written to.
+ */
+#define OS_LOG_RTT_CHANNEL (1)
+
+/**
+ * Size of the RTT buffer for the binary log.
+ */
+#define OS_LOG_BUFFER_SIZE (1024)
+
+/**
+ * Most arguments a single os_log call can take.
+ */
+#define OS_LOG_ARGS_MAX (8)
+
+/**
+ * Format strings are kept in their own section so the host can find them,
+ * the record only carries the address.
+ */
+#define OS_LOG_SECTION __attribute__((section(".os_log"), used))
+
+#define OS_LOG_CONCAT_(a, b) a##b
+#define OS_LOG_CONCAT(a, b)  OS_LOG_CONCAT_(a, b)
+
+/**
+ * The format is the first argument, so __VA_ARGS__ is never empty and none
+ * of this needs GNU's , ##__VA_ARGS__.
+ */
+#define OS_LOG_COUNT_(f, a1, a2, a3, a4, a5, a6, a7, a8, n, ...) n
+#define OS_LOG_COUNT(...)                                         OS_LOG_COUNT_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0, _)
+
+#define OS_LOG_FORMAT_(f, ...) f
+#define OS_LOG_FORMAT(...)     OS_LOG_FORMAT_(__VA_ARGS__, _)
+
+#define OS_LOG_ARG(a)                             (uint32_t)(uintptr_t)(a),
+#define OS_LOG_MAP_0(f)
+#define OS_LOG_MAP_1(f, a)                        OS_LOG_ARG(a)
+#define OS_LOG_MAP_2(f, a, b)                     OS_LOG_ARG(a) OS_LOG_MAP_1(f, b)
+#define OS_LOG_MAP_3(f, a, b, c)                  OS_LOG_ARG(a) OS_LOG_MAP_2(f, b, c)
+#define OS_LOG_MAP_4(f, a, b, c, d)               OS_LOG_ARG(a) OS_LOG_MAP_3(f, b, c, d)
+#define OS_LOG_MAP_5(f, a, b, c, d, e)            OS_LOG_ARG(a) OS_LOG_MAP_4(f, b, c, d, e)
+#define OS_LOG_MAP_6(f, a, b, c, d, e, g)         OS_LOG_ARG(a) OS_LOG_MAP_5(f, b, c, d, e, g)
+#define OS_LOG_MAP_7(f, a, b, c, d, e, g, h)      OS_LOG_ARG(a) OS_LOG_MAP_6(f, b, c, d, e, g, h)
+#define OS_LOG_MAP_8(f, a, b, c, d, e, g, h, i)   OS_LOG_ARG(a) OS_LOG_MAP_7(f, b, c, d, e, g, h, i)
+#define OS_LOG_MAP(...)                           OS_LOG_CONCAT(OS_LOG_MAP_, OS_LOG_COUNT(__VA_ARGS__))(__VA_ARGS__)
+
+/**
+ * Log without formatting on the target. Each argument is stored as a single
+ * word, so %s arguments have to point at constant strings to be resolved on
+ * the host and floating point isn't supported. This never traps, so it's fine
+ * from tasks and IRQs.
+ *
+ * Records are written as little endian words: the format string's address,
+ * os_micros() and then the arguments. The host counts the conversions in
+ * the format string to know how many arguments follow.
+ */
+#define os_log(...)                                                                                                                        \
+    do {                                                                                                                                   \
+        static const char os_log_format[] OS_LOG_SECTION = OS_LOG_FORMAT(__VA_ARGS__);                                                     \
+        const uint32_t os_log_args[] = { OS_LOG_MAP(__VA_ARGS__) 0 };                                                                      \
+        os_log_write(os_log_format, os_log_args, OS_LOG_COUNT(__VA_ARGS__));                                                               \
+    } while (0)
+
+/**
+ * Configure the RTT channel, call before os_log.
+ */
+os_status_t os_log_initialize();
+
+/**
+ * Write one record, prefer the os_log macro.
+ */
+os_status_t os_log_write(const char *format, const uint32_t *args, uint32_t nargs);
+
+/**
+ * Number of records that didn't fit in the buffer.
+ */
+uint32_t os_log_dropped();
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
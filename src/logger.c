@@ -0,0 +1,169 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "internal.h"
+
+/**
+ * Each message is a timestamp and length followed by the characters.
+ */
+typedef struct logger_header_t {
+    uint32_t timestamp;
+    uint32_t size;
+} logger_header_t;
+
+// The ring is only shared with the logger task on the same core, so keeping
+// the compiler from reordering around head/tail is enough.
+#define LOGGER_BARRIER() __asm volatile("" ::: "memory")
+
+// Positions are free running, which only works out when they wrap along
+// with the ring, hence the power of two sizes.
+static void ring_write(os_logger_ring_t *ring, uint32_t position, const void *data, uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        ring->buffer[(position + i) & (ring->size - 1)] = ((const char *)data)[i];
+    }
+}
+
+static void ring_read(os_logger_ring_t *ring, uint32_t position, void *data, uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        ((char *)data)[i] = ring->buffer[(position + i) & (ring->size - 1)];
+    }
+}
+
+os_status_t os_logger_attach(os_task_t *task, os_logger_ring_t *ring, char *buffer, uint32_t size) {
+    if (size < sizeof(logger_header_t) + OS_LOGGER_MESSAGE_MAX || (size & (size - 1)) != 0) {
+        return OSS_ERROR_INVALID;
+    }
+
+    ring->buffer = buffer;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    ring->reported = 0;
+    task->logger = ring;
+
+    return OSS_SUCCESS;
+}
+
+uint32_t osi_logger_append(os_task_t *task, const char *f, va_list args) {
+    os_logger_ring_t *ring = task->logger;
+    char message[OS_LOGGER_MESSAGE_MAX];
+
+    int32_t length = os_vsnprintf(message, sizeof(message), f, args);
+    if (length < 0) {
+        return 0;
+    }
+
+    logger_header_t header = { os_micros(), (uint32_t)length };
+    if (header.size >= sizeof(message)) {
+        header.size = sizeof(message) - 1;
+    }
+
+    uint32_t head = ring->head;
+    uint32_t used = head - ring->tail;
+    if (ring->size - used < sizeof(header) + header.size) {
+        ring->dropped++;
+        return 0;
+    }
+
+    ring_write(ring, head, &header, sizeof(header));
+    ring_write(ring, head + sizeof(header), message, header.size);
+
+    LOGGER_BARRIER();
+    ring->head = head + sizeof(header) + header.size;
+
+    return header.size;
+}
+
+static void logger_default_write(const char *message, uint32_t size, void *arg) {
+    osi_printf("%s", message);
+}
+
+uint32_t os_logger_drain(os_logger_write_fn_t write, void *arg) {
+    uint32_t written = 0;
+
+    if (write == NULL) {
+        write = logger_default_write;
+    }
+
+    while (true) {
+        os_task_t *oldest = NULL;
+        logger_header_t oldest_header = { 0, 0 };
+
+        for (os_task_t *iter = osg.tasks; iter != NULL; iter = iter->np) {
+            os_logger_ring_t *ring = iter->logger;
+            if (ring == NULL) {
+                continue;
+            }
+
+            if (ring->dropped != ring->reported) {
+                char notice[48];
+                uint32_t dropped = ring->dropped;
+                int32_t length = os_snprintf(notice, sizeof(notice), "%s: %u messages dropped\n", iter->name, dropped - ring->reported);
+                // Long task names get cut off, like messages do.
+                if (length >= (int32_t)sizeof(notice)) {
+                    length = sizeof(notice) - 1;
+                }
+                write(notice, length, arg);
+                ring->reported = dropped;
+            }
+
+            if (ring->head == ring->tail) {
+                continue;
+            }
+
+            logger_header_t header;
+            LOGGER_BARRIER();
+            ring_read(ring, ring->tail, &header, sizeof(header));
+            if (oldest == NULL || (int32_t)(header.timestamp - oldest_header.timestamp) < 0) {
+                oldest = iter;
+                oldest_header = header;
+            }
+        }
+
+        if (oldest == NULL) {
+            break;
+        }
+
+        os_logger_ring_t *ring = oldest->logger;
+        char message[OS_LOGGER_MESSAGE_MAX];
+        ring_read(ring, ring->tail + sizeof(logger_header_t), message, oldest_header.size);
+        message[oldest_header.size] = 0;
+
+        LOGGER_BARRIER();
+        ring->tail += sizeof(logger_header_t) + oldest_header.size;
+
+        write(message, oldest_header.size, arg);
+        written++;
+    }
+
+    return written;
+}
+
+uint32_t os_logger_dropped() {
+    uint32_t dropped = 0;
+    for (os_task_t *iter = osg.tasks; iter != NULL; iter = iter->np) {
+        if (iter->logger != NULL) {
+            dropped += iter->logger->dropped;
+        }
+    }
+    return dropped;
+}
+
+void os_logger_task(void *params) {
+    while (true) {
+        os_logger_drain(NULL, NULL);
+        os_delay(OS_LOGGER_PERIOD);
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_LOGGER_H
+#define OS_LOGGER_H
+
+#include <stdarg.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Longest message kept in a ring, including the terminator. Longer
+ * messages are truncated.
+ */
+#define OS_LOGGER_MESSAGE_MAX (96)
+
+/**
+ * How often os_logger_task drains the rings.
+ */
+#define OS_LOGGER_PERIOD (10)
+
+typedef void (*os_logger_write_fn_t)(const char *message, uint32_t size, void *arg);
+
+/**
+ * Give task a ring so its os_printf calls are formatted into the ring in
+ * the task instead of trapping, call before starting the task. The size
+ * has to be a power of two.
+ */
+os_status_t os_logger_attach(os_task_t *task, os_logger_ring_t *ring, char *buffer, uint32_t size);
+
+/**
+ * Write every waiting message, oldest first across all rings. A NULL write
+ * goes to osi_printf. Returns the number of messages written.
+ */
+uint32_t os_logger_drain(os_logger_write_fn_t write, void *arg);
+
+/**
+ * Messages dropped because their ring was full, across all tasks.
+ */
+uint32_t os_logger_dropped();
+
+/**
+ * Handler for a low priority task that drains the rings forever.
+ */
+void os_logger_task(void *params);
+
+/**
+ * Format into the task's ring, dropping the message if it doesn't fit.
+ */
+uint32_t osi_logger_append(os_task_t *task, const char *f, va_list args);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -31,6 +31,40 @@ static os_task_t *blocked_deq(os_mutex_t *mutex) {
     return task;
 }
 
+static void registry_add(os_mutex_t *mutex) {
+    // Creating the same mutex again mustn't link it twice.
+    for (os_mutex_t *iter = osg.mutexes; iter != NULL; iter = iter->next) {
+        if (iter == mutex) {
+            return;
+        }
+    }
+    mutex->next = osg.mutexes;
+    osg.mutexes = mutex;
+}
+
+/**
+ * Free the mutex, giving it to the first waiter if there is one, who's
+ * told status.
+ */
+static void mutex_handover(os_mutex_t *mutex, os_status_t status) {
+    OS_ASSERT(mutex->owner->mutex == NULL);
+    mutex->owner = NULL;
+    OS_LOCK_STATS_RELEASED(&mutex->stats);
+
+    /* Is somebody waiting for this mutex? */
+    if (mutex->blocked.tasks != NULL) {
+        os_task_t *blocked_task = blocked_deq(mutex);
+        mutex->owner = blocked_task;
+        mutex->level = 1;
+        OS_LOCK_STATS_WOKEN(&mutex->stats, blocked_task);
+        OS_LOCK_STATS_HELD(&mutex->stats, blocked_task);
+        osi_task_set_stacked_return(blocked_task, status);
+        osi_dispatch_or_queue(blocked_task);
+    } else if (status == OSS_ERROR_OWNER_DIED) {
+        mutex->flags |= OS_MUTEX_FLAG_OWNER_DIED;
+    }
+}
+
 os_status_t osi_mutex_create(os_mutex_t *mutex, os_mutex_definition_t *def) {
     mutex->def = def;
     mutex->owner = NULL;
@@ -38,6 +72,8 @@ os_status_t osi_mutex_create(os_mutex_t *mutex, os_mutex_definition_t *def) {
     mutex->blocked.tasks = NULL;
     mutex->level = 0;
     mutex->flags = def->flags;
+    OS_LOCK_STATS_CREATED(&mutex->stats, def->name, OS_LOCK_KIND_MUTEX);
+    registry_add(mutex);
     return OSS_SUCCESS;
 }
 
@@ -58,6 +94,12 @@ os_status_t osi_mutex_acquire(os_mutex_t *mutex, uint32_t to) {
     if (mutex->level == 0) {
         mutex->owner = task;
         mutex->level = 1;
+        OS_LOCK_STATS_ACQUIRED(&mutex->stats);
+        OS_LOCK_STATS_HELD(&mutex->stats, task);
+        if (mutex->flags & OS_MUTEX_FLAG_OWNER_DIED) {
+            mutex->flags &= ~OS_MUTEX_FLAG_OWNER_DIED;
+            return OSS_ERROR_OWNER_DIED;
+        }
         return OSS_SUCCESS;
     }
 
@@ -74,6 +116,7 @@ os_status_t osi_mutex_acquire(os_mutex_t *mutex, uint32_t to) {
     }
 
     // Block until somebody releases.
+    OS_LOCK_STATS_BLOCKED(&mutex->stats, task);
     blocked_enq(mutex, task);
     svc_block(to, OS_TASK_FLAG_MUTEX);
     return OSS_ERROR_TO;
@@ -88,18 +131,24 @@ os_status_t osi_mutex_release(os_mutex_t *mutex) {
         return OSS_SUCCESS;
     }
 
-    /* Free the mutex and the check for blocked tasks. */
-    OS_ASSERT(mutex->owner->mutex == NULL);
-    mutex->owner = NULL;
+    mutex_handover(mutex, OSS_SUCCESS);
 
-    /* Is somebody waiting for this mutex? */
-    if (mutex->blocked.tasks != NULL) {
-        os_task_t *blocked_task = blocked_deq(mutex);
-        mutex->owner = blocked_task;
-        mutex->level = 1;
-        osi_task_set_stacked_return(blocked_task, OSS_SUCCESS);
-        osi_dispatch_or_queue(blocked_task);
-    }
+    return OSS_SUCCESS;
+}
+
+os_status_t osi_mutex_abandon(os_mutex_t *mutex) {
+    OS_ASSERT(mutex->level > 0);
+
+    // However deep the owner was, it's never coming back to release.
+    mutex->level = 0;
+    mutex_handover(mutex, OSS_ERROR_OWNER_DIED);
 
     return OSS_SUCCESS;
 }
+
+os_mutex_t *os_mutex_iterate(os_mutex_t *iter) {
+    if (iter == NULL) {
+        return osg.mutexes;
+    }
+    return iter->next;
+}
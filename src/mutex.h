@@ -22,6 +22,12 @@ os_status_t osi_mutex_create(os_mutex_t *mutex, os_mutex_definition_t *def);
 os_status_t osi_mutex_acquire(os_mutex_t *mutex, uint32_t to);
 os_status_t osi_mutex_release(os_mutex_t *mutex);
 
+/**
+ * Release a mutex on behalf of an owner that's no longer running. The next
+ * owner gets OSS_ERROR_OWNER_DIED instead of OSS_SUCCESS.
+ */
+os_status_t osi_mutex_abandon(os_mutex_t *mutex);
+
 #if defined(__cplusplus)
 }
 #endif
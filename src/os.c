@@ -30,6 +30,8 @@ os_globals_t osg = {
     NULL, /* tasks */
     NULL, /* runqueue */
     NULL, /* waitqueue */
+    NULL,  /* deferred */
+    false, /* reschedule */
 };
 
 #define MIN(x, y) (x < y) ? (x) : (y)
@@ -43,12 +45,24 @@ static int32_t stack_paint(uint32_t *stack, size_t size);
 
 static int32_t stack_highwater(uint32_t *stack, size_t size);
 
+static uint32_t stack_guarded(uint32_t *stack);
+
+#if defined(OS_CONFIG_MPU_STACK_GUARD)
+static uintptr_t stack_guard_base(volatile void *stack);
+
+static void stack_guard(os_task_t *task);
+
+static bool stack_guard_hit();
+#endif
+
 static void infinite_loop() __attribute__((noreturn));
 
 static void task_finished() __attribute__((noreturn));
 
 static bool task_is_running(os_task_t *task);
 
+static bool task_is_dead(uint8_t status);
+
 static uint32_t runqueue_length(os_task_t *head);
 
 static void runqueue_add(os_task_t **head, os_task_t *task);
@@ -57,6 +71,14 @@ static void runqueue_remove(os_task_t **head, os_task_t *task);
 
 static bool runqueue_has_higher_priority(os_task_t *task);
 
+static bool scheduler_is_locked();
+
+static os_priority_t task_threshold(os_task_t *task);
+
+static void dispatch_defer(os_task_t *task);
+
+static void task_unblock(os_task_t *task);
+
 static void waitqueue_add(os_task_t **head, os_task_t *task);
 
 static void waitqueue_remove(os_task_t **head, os_task_t *task);
@@ -94,6 +116,20 @@ os_status_t os_teardown() {
     osg.tasks = NULL;
     osg.runqueue = NULL;
     osg.waitqueue = NULL;
+    osg.deferred = NULL;
+    osg.reschedule = false;
+    osg.queues = NULL;
+    osg.mutexes = NULL;
+    osg.semaphores = NULL;
+    osg.rwlocks = NULL;
+    osg.stack_scan = NULL;
+#if defined(OS_CONFIG_WATCHDOG)
+    osg.watchdogs = NULL;
+    osg.watchdog_overdue = NULL;
+#endif
+#if defined(OS_CONFIG_SUPERVISOR)
+    osg.supervisors = NULL;
+#endif
 
     return OSS_SUCCESS;
 }
@@ -107,7 +143,6 @@ uint32_t *initialize_stack(os_task_t *task, uint32_t *stack, size_t stack_size)
     OS_ASSERT(stack_size >= OS_STACK_MINIMUM_SIZE);
 
     uint32_t stack_offset = (stack_size / sizeof(uint32_t));
-    stack_paint(stack, stack_offset);
 
     // Check alignment. May not be necessary?
     uint32_t *stk = stack + stack_offset;
@@ -116,6 +151,11 @@ uint32_t *initialize_stack(os_task_t *task, uint32_t *stack, size_t stack_size)
     }
     stk -= OS_STACK_BASIC_FRAME_SIZE;
 
+#if defined(OS_CONFIG_MPU_STACK_GUARD)
+    // The initial frame has to be above the guard.
+    OS_ASSERT((uint32_t)(stk - stack) >= stack_guarded(stack));
+#endif
+
     /* Save values of registers which will be restored on exc. return:
        - XPSR: Default value (0x01000000)
        - PC: Point to the handler function
@@ -163,15 +203,64 @@ uint32_t *initialize_stack(os_task_t *task, uint32_t *stack, size_t stack_size)
     // Magic word to check for overflows.
     stack[0] = OSH_STACK_MAGIC_WORD;
 
+    // Nothing below the initial frame has been used yet.
+    task->highwater = stk - stack;
+    task->highwater_scan = stack_guarded(stack);
+
     return stk;
 }
 
 uint32_t os_task_highwater(os_task_t *task) {
-    task->highwater = stack_highwater((uint32_t *)task->stack, task->stack_size);
+    // The guard may belong to the running task, and is never used anyway.
+    uint32_t *stack = (uint32_t *)task->stack;
+    uint32_t guarded = stack_guarded(stack);
+    task->highwater = guarded + stack_highwater(stack + guarded, task->stack_size / sizeof(uint32_t) - guarded);
+    task->highwater_scan = guarded;
 
     return task->highwater;
 }
 
+/**
+ * Each task is scanned from the bottom of its stack up to the known
+ * boundary, over as many calls as it takes. A used word moves the boundary
+ * down, either way we then move on to the next task and its next round
+ * starts from the bottom again, just above any guard.
+ */
+void os_stack_scan(uint32_t words) {
+    while (words > 0) {
+        if (osg.stack_scan == NULL) {
+            osg.stack_scan = osg.tasks;
+            if (osg.stack_scan == NULL) {
+                return;
+            }
+        }
+
+        os_task_t *scanning = osg.stack_scan;
+        uint32_t *stack = (uint32_t *)scanning->stack;
+        uint32_t i = scanning->highwater_scan;
+        for (; words > 0 && i < scanning->highwater; ++i, --words) {
+            if (stack[i] != OSH_STACK_MAGIC_WORD) {
+                scanning->highwater = i;
+                break;
+            }
+        }
+
+        if (i < scanning->highwater) {
+            scanning->highwater_scan = i;
+            return;
+        }
+
+        scanning->highwater_scan = stack_guarded(stack);
+        osg.stack_scan = scanning->np;
+
+        // At most one lap per call, an overflowed stack can have nothing
+        // left to scan.
+        if (osg.stack_scan == NULL) {
+            return;
+        }
+    }
+}
+
 void *os_task_user_data_get(os_task_t *task) {
     return task->user_data;
 }
@@ -182,7 +271,7 @@ void os_task_user_data_set(os_task_t *task, void *user_data) {
 
 os_status_t os_task_initialize(os_task_t *task, const char *name, os_start_status status, void (*handler)(void *params), void *params,
                                uint32_t *stack, size_t stack_size) {
-    os_task_options_t options = { name, status, handler, params, stack, stack_size, OS_PRIORITY_NORMAL };
+    os_task_options_t options = { name, status, handler, params, stack, stack_size, OS_PRIORITY_NORMAL, 0 };
     return os_task_initialize_options(task, &options);
 }
 
@@ -209,20 +298,30 @@ os_status_t os_task_initialize_options(os_task_t *task, os_task_options_t *optio
     task->nblocked = NULL;
     task->semaphore = NULL;
     task->rwlock = NULL;
+    memset(task->rwlock_reads, 0, sizeof(task->rwlock_reads));
+    task->scheduler_locks = 0;
     task->c.message = NULL;
     task->nrp = NULL;
     task->priority = options->priority;
+    task->preemption_threshold = options->preemption_threshold;
     task->signal = 0;
+    task->logger = NULL;
 #if defined(OS_CONFIG_DEBUG)
     task->debug_stack_max = 0;
 #endif
+#if defined(OS_CONFIG_LOCK_STATS)
+    task->blocked_since = 0;
+#endif
 
+    stack_paint(options->stack, options->stack_size / sizeof(uint32_t));
     task->sp = initialize_stack(task, options->stack, options->stack_size);
 
     task->np = osg.tasks;
     osg.tasks = task;
     osg.ntasks++;
 
+    OS_TRACE_TASK_CREATE(task);
+
     /* First task initialized is always the idle task, it's also the task that
      * gets a turn first. */
     if (osg.idle == NULL) {
@@ -280,6 +379,8 @@ os_status_t os_task_start_options(os_task_t *task, uint8_t priority, void *param
     task->queue = NULL;
     task->mutex = NULL;
     task->rwlock = NULL;
+    memset(task->rwlock_reads, 0, sizeof(task->rwlock_reads));
+    task->scheduler_locks = 0;
     task->c.message = NULL;
     task->nblocked = NULL;
     task->params = params;
@@ -291,7 +392,16 @@ os_status_t os_task_start_options(os_task_t *task, uint8_t priority, void *param
 #if defined(OS_CONFIG_DEBUG)
     task->debug_stack_max = 0;
 #endif
-    task->sp = initialize_stack(task, (uint32_t *)task->stack, task->stack_size);
+#if defined(OS_CONFIG_LOCK_STATS)
+    task->blocked_since = 0;
+#endif
+    // Only repaint above the mark os_stack_scan has found so far. Anything
+    // deeper it hasn't reached yet stays dirty and keeps counting as used,
+    // so the mark can be high but never low.
+    uint32_t *stack = (uint32_t *)task->stack;
+    uint32_t stack_words = task->stack_size / sizeof(uint32_t);
+    stack_paint(stack + task->highwater, stack_words - task->highwater);
+    task->sp = initialize_stack(task, stack, task->stack_size);
     task->status = OS_TASK_STATUS_IDLE;
 
     // Kind of a hack :)
@@ -318,6 +428,10 @@ os_status_t os_task_suspend(os_task_t *task) {
     osi_printf("%s: suspended\n", task->name);
 #endif
 
+    // Otherwise whatever it timed out on could still hand it over and wake
+    // it up again.
+    task_unblock(task);
+
     osi_task_status_set(task, OS_TASK_STATUS_SUSPENDED);
 
     return OSS_SUCCESS;
@@ -383,6 +497,10 @@ os_status_t os_start(void) {
 #if !defined(__linux__)
     __set_PSP((uint32_t)osg.running->sp + OS_STACK_BASIC_FRAME_SIZE);
 #endif
+#endif
+#if defined(OS_CONFIG_MPU_STACK_GUARD)
+    stack_guard((os_task_t *)osg.running);
+    MPU->CTRL = MPU_CTRL_PRIVDEFENA_Msk | MPU_CTRL_ENABLE_Msk;
 #endif
     /* Switch to Unprivilleged Thread Mode with PSP */
     __set_CONTROL(0x02);
@@ -425,15 +543,37 @@ os_status_t osi_task_status_set(os_task_t *task, os_task_status new_status) {
         runqueue_add(&osg.runqueue, task);
     }
 
+    OS_TRACE_TASK_STATUS(task, old_status);
+
     if (osg.status_hook != NULL) {
         osg.status_hook(task, old_status);
     }
 
+    // Otherwise anybody waiting on what it held would wait forever.
+    if (task_is_dead(new_status) && !task_is_dead(old_status)) {
+        osi_task_abandon_locks(task);
+    }
+
     OS_UNLOCK();
 
     return new_status;
 }
 
+os_status_t osi_task_abandon_locks(os_task_t *task) {
+    OS_ASSERT(!os_task_status_is_running(task->status));
+
+    for (os_mutex_t *iter = osg.mutexes; iter != NULL; iter = iter->next) {
+        if (iter->level > 0 && iter->owner == task) {
+            osi_mutex_abandon(iter);
+        }
+    }
+    for (os_rwlock_t *iter = osg.rwlocks; iter != NULL; iter = iter->next) {
+        osi_rwlock_abandon(iter, task);
+    }
+
+    return OSS_SUCCESS;
+}
+
 os_status_t osi_dispatch_or_queue(os_task_t *task) {
     if (runqueue_has_higher_priority(task)) {
         if (!task_is_running(task)) {
@@ -448,6 +588,18 @@ os_status_t osi_dispatch_or_queue(os_task_t *task) {
     return OSS_SUCCESS;
 }
 
+os_status_t osi_dispatch_isr(os_task_t *task) {
+    // Several tasks may be woken by the same IRQ, so we only remember the
+    // most important one and leave the switch to PendSV.
+    dispatch_defer(task);
+
+#if defined(__SAMD21__) || defined(__SAMD51__)
+    SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
+#endif
+
+    return OSS_SUCCESS;
+}
+
 os_status_t osi_dispatch(os_task_t *task) {
     OS_ASSERT(task != NULL);
     OS_ASSERT(osg.running != NULL);
@@ -461,67 +613,13 @@ os_status_t osi_dispatch(os_task_t *task) {
     }
 #endif
 
-    if ((task->flags & OS_TASK_FLAG_MUTEX) == OS_TASK_FLAG_MUTEX) {
-        OS_ASSERT(task->queue == NULL);
-        OS_ASSERT(task->mutex != NULL);
-        OS_ASSERT(task->semaphore == NULL);
-        OS_ASSERT(task->rwlock == NULL);
-
-#if defined(OS_CONFIG_DEBUG_MUTEXES)
-        osi_printf("%s: removed from mutex %p\n", task->name, task->mutex);
-#endif
-
-        if (task->mutex->blocked.tasks == task) {
-            task->mutex->blocked.tasks = task->nblocked;
-            task->nblocked = NULL;
-        }
-
-        blocked_remove(&task->mutex->blocked, task);
-
-        // NOTE: If we can see if they got the mutex we can decide to end the
-        // task here if not and the right flags are set.
-
-        task->mutex = NULL;
-        task->flags = 0;
-    }
-    if ((task->flags & OS_TASK_FLAG_QUEUE) == OS_TASK_FLAG_QUEUE) {
-        OS_ASSERT(task->mutex == NULL);
-        OS_ASSERT(task->queue != NULL);
-        OS_ASSERT(task->semaphore == NULL);
-        OS_ASSERT(task->rwlock == NULL);
-
-#if defined(OS_CONFIG_DEBUG_QUEUES)
-        osi_printf("%s: removed from queue %p\n", task->name, task->queue);
-#endif
-
-        blocked_remove(&task->queue->blocked, task);
-
-        task->queue = NULL;
-        task->flags = 0;
-    }
-    if ((task->flags & OS_TASK_FLAG_SEMAPHORE) == OS_TASK_FLAG_SEMAPHORE) {
-        OS_ASSERT(task->mutex == NULL);
-        OS_ASSERT(task->queue == NULL);
-        OS_ASSERT(task->semaphore != NULL);
-        OS_ASSERT(task->rwlock == NULL);
-
-        blocked_remove(&task->semaphore->blocked, task);
-
-        task->semaphore = NULL;
-        task->flags = 0;
+    // The switch happens when the running task unlocks the scheduler.
+    if (scheduler_is_locked()) {
+        dispatch_defer(task);
+        return OSS_SUCCESS;
     }
-    if ((task->flags & OS_TASK_FLAG_RWLOCK) == OS_TASK_FLAG_RWLOCK) {
-        OS_ASSERT(task->mutex == NULL);
-        OS_ASSERT(task->queue == NULL);
-        OS_ASSERT(task->semaphore == NULL);
-        OS_ASSERT(task->rwlock != NULL);
 
-        blocked_remove(&task->rwlock->blocked, task);
-
-        task->c.desired = 0;
-        task->rwlock = NULL;
-        task->flags = 0;
-    }
+    task_unblock(task);
 
     // NOTE: Should the status update happen when we actually switch?
     os_task_t *running = (os_task_t *)osg.running;
@@ -558,6 +656,8 @@ os_status_t osi_dispatch(os_task_t *task) {
     task->flags = 0;
     task->status = OS_TASK_STATUS_ACTIVE;
 
+    OS_TRACE_TASK_STATUS(task, old_status);
+
     // If this task was waiting and is being given a chance, change queues.
     if (old_status == OS_TASK_STATUS_WAIT) {
         waitqueue_remove(&osg.waitqueue, task);
@@ -604,6 +704,121 @@ static bool task_is_running(os_task_t *task) {
     return os_task_status_is_running(task->status);
 }
 
+static bool task_is_dead(uint8_t status) {
+    return status == OS_TASK_STATUS_FINISHED || status == OS_TASK_STATUS_PANIC || status == OS_TASK_STATUS_ABORTED;
+}
+
+/**
+ * The scheduler lock only keeps the running task from being preempted, if
+ * it blocks or stops then somebody else has to run.
+ */
+static bool scheduler_is_locked() {
+    os_task_t *running = (os_task_t *)osg.running;
+    return running != NULL && running->scheduler_locks > 0 && task_is_running(running);
+}
+
+static void dispatch_defer(os_task_t *task) {
+    if (!task_is_running(task)) {
+        osi_task_status_set(task, OS_TASK_STATUS_IDLE);
+    }
+
+    if (osg.deferred == NULL || task->priority > osg.deferred->priority) {
+        osg.deferred = task;
+    }
+}
+
+/**
+ * Being taken off a blocked list is only a timeout once the deadline has
+ * passed, tasks can also be suspended or restarted while waiting.
+ */
+static inline bool task_timed_out(os_task_t *task) {
+    return task->delay != UINT32_MAX && os_uptime() >= task->delay;
+}
+
+/**
+ * Takes the task off whatever it blocked on. Tasks that time out stay on
+ * the blocked list until they're dispatched or suspended.
+ */
+static void task_unblock(os_task_t *task) {
+    if ((task->flags & OS_TASK_FLAG_MUTEX) == OS_TASK_FLAG_MUTEX) {
+        OS_ASSERT(task->queue == NULL);
+        OS_ASSERT(task->mutex != NULL);
+        OS_ASSERT(task->semaphore == NULL);
+        OS_ASSERT(task->rwlock == NULL);
+
+#if defined(OS_CONFIG_DEBUG_MUTEXES)
+        osi_printf("%s: removed from mutex %p\n", task->name, task->mutex);
+#endif
+
+#if defined(OS_CONFIG_LOCK_STATS)
+        // Whoever released the mutex handed it over, otherwise we gave up.
+        if (task->mutex->owner != task && task_timed_out(task)) {
+            OS_LOCK_STATS_TIMEOUT(&task->mutex->stats, task);
+        }
+#endif
+
+        if (task->mutex->blocked.tasks == task) {
+            task->mutex->blocked.tasks = task->nblocked;
+            task->nblocked = NULL;
+        }
+
+        blocked_remove(&task->mutex->blocked, task);
+
+        // NOTE: If we can see if they got the mutex we can decide to end the
+        // task here if not and the right flags are set.
+
+        task->mutex = NULL;
+        task->flags = 0;
+    }
+    if ((task->flags & OS_TASK_FLAG_QUEUE) == OS_TASK_FLAG_QUEUE) {
+        OS_ASSERT(task->mutex == NULL);
+        OS_ASSERT(task->queue != NULL);
+        OS_ASSERT(task->semaphore == NULL);
+        OS_ASSERT(task->rwlock == NULL);
+
+#if defined(OS_CONFIG_DEBUG_QUEUES)
+        osi_printf("%s: removed from queue %p\n", task->name, task->queue);
+#endif
+
+        // Still blocked means we timed out.
+        if (blocked_remove(&task->queue->blocked, task)) {
+#if defined(OS_CONFIG_QUEUE_STATS)
+            task->queue->stats.timeouts++;
+#endif
+        }
+
+        task->queue = NULL;
+        task->flags = 0;
+    }
+    if ((task->flags & OS_TASK_FLAG_SEMAPHORE) == OS_TASK_FLAG_SEMAPHORE) {
+        OS_ASSERT(task->mutex == NULL);
+        OS_ASSERT(task->queue == NULL);
+        OS_ASSERT(task->semaphore != NULL);
+        OS_ASSERT(task->rwlock == NULL);
+
+        if (blocked_remove(&task->semaphore->blocked, task) && task_timed_out(task)) {
+            OS_LOCK_STATS_TIMEOUT(&task->semaphore->stats, task);
+        }
+
+        task->semaphore = NULL;
+        task->flags = 0;
+    }
+    if ((task->flags & OS_TASK_FLAG_RWLOCK) == OS_TASK_FLAG_RWLOCK) {
+        OS_ASSERT(task->mutex == NULL);
+        OS_ASSERT(task->queue == NULL);
+        OS_ASSERT(task->semaphore == NULL);
+        OS_ASSERT(task->rwlock != NULL);
+
+        if (blocked_remove(&task->rwlock->blocked, task) && task_timed_out(task)) {
+            OS_LOCK_STATS_TIMEOUT(&task->rwlock->stats, task);
+        }
+
+        task->c.desired = 0;
+        task->rwlock = NULL;
+        task->flags = 0;
+    }
+}
+
 static bool is_higher_priority(os_priority_t a, os_priority_t b) {
     return a > b;
 }
@@ -612,11 +827,35 @@ static bool is_equal_priority(os_priority_t a, os_priority_t b) {
     return a == b;
 }
 
+static os_priority_t task_threshold(os_task_t *task) {
+    if (task->preemption_threshold > task->priority) {
+        return task->preemption_threshold;
+    }
+    return task->priority;
+}
+
 static os_task_t *find_new_task(os_task_t *running) {
     // Default to the running task just in case we don't go through the loop
     // or we're the only task, etc...
     os_task_t *new_task = NULL;
 
+    // With a threshold only tasks above that get to preempt us, and there's
+    // no round robin. The runqueue is sorted so the first runnable task is
+    // the only one worth looking at.
+    os_priority_t threshold = task_threshold(running);
+    if (task_is_running(running) && threshold > running->priority) {
+        for (os_task_t *task = osg.runqueue; task != NULL; task = task->nrp) {
+            if (task != running && task_is_running(task)) {
+                if (is_higher_priority(task->priority, threshold)) {
+                    new_task = task;
+                    osi_priority_check(new_task); // TODO: SLOW/PARANOID
+                }
+                break;
+            }
+        }
+        return new_task;
+    }
+
     // Look for a task that's higher priority than us (~lower~ HIGHER number)
     // I'm confused because is_higher_priority is checking for a priority
     // greater than "ours" and things definitely fail with that set. Yes this
@@ -684,6 +923,11 @@ os_status_t osi_schedule() {
         return OSS_SUCCESS;
     }
 
+    if (scheduler_is_locked()) {
+        osg.reschedule = true;
+        return OSS_SUCCESS;
+    }
+
     // Check to see if anything in the waitqueue is free to go.
     uint32_t now = os_uptime();
     for (os_task_t *task = osg.waitqueue; task != NULL; task = task->nrp) {
@@ -762,13 +1006,98 @@ uint32_t osi_task_get_stacked_return(os_task_t *task) {
     return regs[0];
 }
 
+os_status_t osi_reschedule() {
+    if (scheduler_is_locked()) {
+        return OSS_SUCCESS;
+    }
+
+    os_task_t *task = osg.deferred;
+    bool reschedule = osg.reschedule;
+    osg.deferred = NULL;
+    osg.reschedule = false;
+
+    if (task != NULL && osg.running != NULL && task_is_running(task) && task != osg.running) {
+        // Something may have been scheduled since, so only override that
+        // when the woken task is more important.
+        os_task_t *scheduled = (os_task_t *)osg.scheduled;
+        if (scheduled != NULL && is_higher_priority(task->priority, scheduled->priority)) {
+            scheduled->status = OS_TASK_STATUS_IDLE;
+            osg.scheduled = NULL;
+            // Dispatching that switch idled the running task, put it back or
+            // osi_schedule will think it's already on its way out.
+            if (osg.running->status == OS_TASK_STATUS_IDLE) {
+                osg.running->status = OS_TASK_STATUS_ACTIVE;
+            }
+        }
+        if (osg.scheduled == NULL) {
+            osi_dispatch_or_queue(task);
+        }
+    }
+
+    if (reschedule && osg.running != NULL && osg.scheduled == NULL) {
+        return osi_schedule();
+    }
+
+    return OSS_SUCCESS;
+}
+
+void osi_pendsv() {
+    OS_LOCK();
+
+    osi_reschedule();
+
+// We're already in PendSV and about to switch, so don't come back.
+#if defined(__SAMD21__) || defined(__SAMD51__)
+    SCB->ICSR = SCB_ICSR_PENDSVCLR_Msk;
+#endif
+
+    OS_UNLOCK();
+}
+
 os_status_t osi_irs_systick() {
+    os_status_t err = OSS_SUCCESS;
+
+    OS_TRACE_ISR_ENTER();
+
     if (osg.state == OS_STATE_STARTED) {
         // We could have beeen in another IRQ and scheduled something, then
         // SysTick fired before we fell down to PendSV?
         if (osg.scheduled == NULL) {
-            return osi_schedule();
+            err = osi_schedule();
         }
+
+#if defined(OS_CONFIG_SUPERVISOR)
+        osi_supervise();
+#endif
+
+#if defined(OS_CONFIG_WATCHDOG)
+        osi_watchdog_supervise();
+#endif
+    }
+
+    OS_TRACE_ISR_EXIT();
+
+    return err;
+}
+
+static const char *owner_name(os_task_t *task) {
+    return task != NULL ? task->name : "-";
+}
+
+os_status_t os_objects_dump() {
+    for (os_queue_t *iter = osg.queues; iter != NULL; iter = iter->next) {
+        osi_printf("  queue '%s' %d/%d blocked(%s)\n", iter->def->name, iter->number, iter->size, owner_name(iter->blocked.tasks));
+    }
+    for (os_mutex_t *iter = osg.mutexes; iter != NULL; iter = iter->next) {
+        osi_printf("  mutex '%s' owner(%s) level(%d) blocked(%s)\n", iter->def->name, owner_name(iter->owner), iter->level,
+                   owner_name(iter->blocked.tasks));
+    }
+    for (os_semaphore_t *iter = osg.semaphores; iter != NULL; iter = iter->next) {
+        osi_printf("  semaphore '%s' tokens(%d) blocked(%s)\n", iter->def->name, iter->tokens, owner_name(iter->blocked.tasks));
+    }
+    for (os_rwlock_t *iter = osg.rwlocks; iter != NULL; iter = iter->next) {
+        osi_printf("  rwlock '%s' readers(%d) writer(%s) blocked(%s)\n", iter->def->name, iter->readers, owner_name(iter->writer),
+                   owner_name(iter->blocked.tasks));
     }
     return OSS_SUCCESS;
 }
@@ -785,6 +1114,8 @@ const char *os_status_str(os_status_t status) {
         return "OSS_ERROR_INT";
     case OSS_ERROR_INVALID:
         return "OSS_ERROR_INVALID";
+    case OSS_ERROR_OWNER_DIED:
+        return "OSS_ERROR_OWNER_DIED";
     default:
         return "UNKNOWN";
     }
@@ -821,6 +1152,10 @@ const char *os_panic_kind_str(os_panic_kind_t kind) {
         return "OS_PANIC_STACK_OVERFLOW";
     case OS_PANIC_APP:
         return "OS_PANIC_APP";
+    case OS_PANIC_WATCHDOG:
+        return "OS_PANIC_WATCHDOG";
+    case OS_PANIC_SUPERVISOR:
+        return "OS_PANIC_SUPERVISOR";
     case OS_PANIC_UNKNOWN:
         return "OS_PANIC_UNKNOWN";
     default:
@@ -859,9 +1194,17 @@ void osi_priority_check(os_task_t *scheduled) {
 }
 
 void osi_stack_check() {
+#if defined(OS_CONFIG_MPU_STACK_GUARD)
+    // Overflows fault on their own, so just move the guard under the
+    // incoming task's stack.
+    if (osg.scheduled != NULL) {
+        stack_guard((os_task_t *)osg.scheduled);
+    }
+#else
     if ((osg.running->sp < osg.running->stack) || (((uint32_t *)osg.running->stack)[0] != OSH_STACK_MAGIC_WORD)) {
-        osi_panic(OS_PANIC_STACK_OVERFLOW);
+        osi_crash(OS_PANIC_STACK_OVERFLOW);
     }
+#endif
 
 #if __pic__ && defined(__SAMD51__)
     register uint32_t got_r9 asm("r9");
@@ -870,6 +1213,11 @@ void osi_stack_check() {
 #endif
 
     osi_priority_check((os_task_t *)osg.scheduled); // TODO: SLOW/PARANOID
+
+    // The M0 calls this again after the switch, so only trace the first.
+    if (osg.scheduled != NULL && osg.scheduled != osg.running) {
+        OS_TRACE_TASK_SWITCH((os_task_t *)osg.scheduled);
+    }
 }
 
 void osi_hard_fault_handler(uintptr_t *stack, uint32_t lr) {
@@ -879,6 +1227,12 @@ void osi_hard_fault_handler(uintptr_t *stack, uint32_t lr) {
         return;                   // Return to application
     }
 
+#if defined(OS_CONFIG_MPU_STACK_GUARD)
+    if (stack_guard_hit()) {
+        osi_crash(OS_PANIC_STACK_OVERFLOW);
+    }
+#endif
+
     cortex_hard_fault_t hfr;
     hfr.syshndctrl.byte = SYSHND_CTRL; // System Handler Control and State Register
     hfr.mfsr.byte = NVIC_MFSR;         // Memory Fault Status Register
@@ -898,9 +1252,21 @@ void osi_hard_fault_handler(uintptr_t *stack, uint32_t lr) {
     hfr.registers.PC = (void *)stack[6];  // Program counter PC
     hfr.registers.psr.byte = stack[7];    // Program status word PSR
 
+#if defined(OS_CONFIG_CRASH_SNAPSHOT)
+    osi_crash_capture(OS_CRASH_HARD_FAULT, stack, lr, &hfr);
+#endif
+
     osi_hard_fault_report(stack, lr, &hfr);
 }
 
+void osi_crash(os_panic_kind_t code) {
+#if defined(OS_CONFIG_CRASH_SNAPSHOT)
+    osi_crash_capture(code, NULL, 0, NULL);
+#endif
+
+    osi_panic(code);
+}
+
 static void task_finished() {
     OS_ASSERT(osg.running != NULL);
     OS_ASSERT(osg.running != osg.idle);
@@ -910,10 +1276,9 @@ static void task_finished() {
     osi_printf("os: task '%s' finished\n", osg.running->name);
 #endif
 
-    osi_task_status_set((os_task_t *)osg.running, OS_TASK_STATUS_FINISHED);
-
-    // We're removed from the runqueue but still running until we get preempted
-    // by the scheduler tick.
+    // Finishing releases held locks and may wake their waiters, so do it in
+    // handler mode like svc_abort, which also switches away right away.
+    __svc_finish();
 
     infinite_loop();
 }
@@ -995,6 +1360,10 @@ static bool runqueue_has_higher_priority(os_task_t *task) {
             if (iter->priority > task->priority) {
                 return true;
             }
+            // The running task holds off anything at or below its threshold.
+            if (iter == osg.running && task_threshold(iter) > iter->priority && task_threshold(iter) >= task->priority) {
+                return true;
+            }
         }
     }
     return false;
@@ -1094,3 +1463,54 @@ static int32_t stack_highwater(uint32_t *stack, size_t size) {
     }
     return size;
 }
+
+/**
+ * Words at the bottom of the stack up to the end of the guard, these are
+ * never used.
+ */
+static uint32_t stack_guarded(uint32_t *stack) {
+#if defined(OS_CONFIG_MPU_STACK_GUARD)
+    return (stack_guard_base(stack) + OS_STACK_GUARD_SIZE - (uintptr_t)stack) / sizeof(uint32_t);
+#else
+    return 0;
+#endif
+}
+
+#if defined(OS_CONFIG_MPU_STACK_GUARD)
+
+/**
+ * Regions have to be aligned to their size, so the guard is the first
+ * aligned block in the stack.
+ */
+static uintptr_t stack_guard_base(volatile void *stack) {
+    return ((uintptr_t)stack + OS_STACK_GUARD_SIZE - 1) & ~(uintptr_t)(OS_STACK_GUARD_SIZE - 1);
+}
+
+static void stack_guard(os_task_t *task) {
+    // Writing RBAR with VALID set also selects the region. SIZE encodes
+    // 2^(SIZE + 1) bytes, so 4 is OS_STACK_GUARD_SIZE, and AP of zero is no
+    // access at all.
+    MPU->RBAR = stack_guard_base(task->stack) | MPU_RBAR_VALID_Msk | OS_STACK_GUARD_MPU_REGION;
+    MPU->RASR = MPU_RASR_XN_Msk | (4 << MPU_RASR_SIZE_Pos) | MPU_RASR_ENABLE_Msk;
+    __DSB();
+    __ISB();
+}
+
+/**
+ * The guard is the only region, so any stacking error is the running task
+ * pushing past the bottom of its stack, otherwise check the address.
+ */
+static bool stack_guard_hit() {
+    uint8_t mfsr = NVIC_MFSR;
+    if (mfsr & (1u << 4)) { // MSTKERR
+        return true;
+    }
+    if (mfsr & (1u << 7)) { // MMARVALID
+        uintptr_t guard = stack_guard_base(osg.running->stack);
+        uintptr_t address = NVIC_MMFAR;
+        return address >= guard && address < guard + OS_STACK_GUARD_SIZE;
+    }
+    return false;
+}
+
+#endif
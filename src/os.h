@@ -55,6 +55,8 @@ typedef enum {
     OS_PANIC_ASSERTION,
     OS_PANIC_STACK_OVERFLOW,
     OS_PANIC_APP,
+    OS_PANIC_WATCHDOG,
+    OS_PANIC_SUPERVISOR,
     OS_PANIC_UNKNOWN,
 } os_panic_kind_t;
 
@@ -163,8 +165,23 @@ uint32_t os_task_uptime(os_task_t *task);
  */
 uint32_t os_task_runtime(os_task_t *task);
 
+/**
+ * Scan the whole stack now, returns the number of words at the bottom of
+ * the stack that have never been used.
+ */
 uint32_t os_task_highwater(os_task_t *task);
 
+/**
+ * Keeps every task's highwater current a little at a time, looking at no
+ * more than words stack words per call. Call from the idle task's loop.
+ */
+void os_stack_scan(uint32_t words);
+
+/**
+ * Reasonable number of words for os_stack_scan from a busy idle loop.
+ */
+#define OS_STACK_SCAN_WORDS (16)
+
 /**
  *
  */
@@ -208,5 +225,13 @@ void osi_assert(const char *assertion, const char *file, int line);
 
 #include "service.h"
 #include "syscall_plumbing.h"
+#include "log.h"
+#include "logger.h"
+#include "trace.h"
+#include "crash.h"
+#include "lockstats.h"
+#include "watchdog.h"
+#include "supervisor.h"
+#include "shell.h"
 
 #endif /* OS_H */
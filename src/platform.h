@@ -36,6 +36,33 @@ uint32_t osi_platform_delay(uint32_t ms);
 
 uint32_t osi_platform_micros();
 
+/**
+ * Free running cycle counter, only used for relative measurements.
+ */
+uint32_t osi_platform_cycles();
+
+#if defined(OS_CONFIG_CRASH_SNAPSHOT)
+
+/**
+ * Called once a crash snapshot is complete, just before the reset. It's
+ * already in RAM that survives the reset on hardware.
+ */
+void osi_platform_crash_saved(os_crash_snapshot_t *snapshot);
+
+#endif
+
+#if defined(OS_CONFIG_WATCHDOG)
+
+/**
+ * Enable the hardware watchdog, resetting unless it's fed at least every
+ * timeout ms. Hardware rounds the timeout up to what it supports.
+ */
+os_status_t osi_platform_watchdog_start(uint32_t timeout);
+
+void osi_platform_watchdog_feed();
+
+#endif
+
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,369 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_PRINT_H
+#define OS_PRINT_H
+
+#if defined(__cplusplus)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+#include "os.h"
+
+/**
+ * Size of the stack buffer OS_PRINT formats into.
+ */
+#define OS_PRINT_BUFFER_SIZE (96)
+
+/**
+ * Format strings use {} placeholders, optionally with a spec like {:x},
+ * {:08X}, {:5d}, {:b}, {:c}, {:s} or {:p}. Use {{ and }} for literal braces.
+ * The number of placeholders and each spec's kind are checked against the
+ * arguments at compile time, so {:s} on an int doesn't build. The format
+ * is still walked at runtime to copy the literal text and read widths, but
+ * there are no varargs, each conversion is picked by the argument's type.
+ *
+ *   OS_PRINT("{} has {} items, mask {:04x}\n", name, n, mask);
+ *
+ * C++11 has no string literal template arguments, so the format can't be
+ * turned into a type, these macros do the checking instead.
+ */
+#define OS_FORMAT(buffer, size, f, ...) (OS_FORMAT_CHECK(f, __VA_ARGS__), os::format(buffer, size, f, ##__VA_ARGS__))
+
+#define OS_PRINT(f, ...) (OS_FORMAT_CHECK(f, __VA_ARGS__), os::print(f, ##__VA_ARGS__))
+
+#define OS_FORMAT_CHECK(f, ...)                                                                                                            \
+    static_cast<void>(os::detail::check<os::detail::placeholders(f), OS_PRINT_ARGS(__VA_ARGS__),                                           \
+                                        os::detail::placeholders(f) != OS_PRINT_ARGS(__VA_ARGS__) ||                                       \
+                                            decltype(os::detail::types(__VA_ARGS__))::accepted(f, 0)>::value)
+
+#define OS_PRINT_ARGS(...) (sizeof(os::detail::counter(__VA_ARGS__)) - 1)
+
+namespace os {
+
+namespace detail {
+
+constexpr size_t invalid = (size_t)-1;
+
+template <typename... Args> char (&counter(Args &&...))[sizeof...(Args) + 1];
+
+constexpr bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool is_kind(char c) {
+    return c == 'd' || c == 'u' || c == 'x' || c == 'X' || c == 'b' || c == 'c' || c == 's' || c == 'p';
+}
+
+/**
+ * Points past the closing brace of a spec starting after the colon, or at
+ * nullptr when the spec is malformed.
+ */
+constexpr const char *skip_spec(const char *f) {
+    return is_digit(*f) ? skip_spec(f + 1) : is_kind(*f) ? (f[1] == '}' ? f + 2 : nullptr) : (*f == '}' ? f + 1 : nullptr);
+}
+
+constexpr size_t add(size_t n, size_t more) {
+    return more == invalid ? invalid : n + more;
+}
+
+constexpr size_t placeholders(const char *f);
+
+constexpr size_t placeholder(const char *f) {
+    return f[0] == '}' ? add(1, placeholders(f + 1))
+                       : f[0] == ':' ? (skip_spec(f + 1) == nullptr ? invalid : add(1, placeholders(skip_spec(f + 1)))) : invalid;
+}
+
+/**
+ * Number of {} placeholders in f, or invalid.
+ */
+constexpr size_t placeholders(const char *f) {
+    return *f == 0 ? 0
+                   : (f[0] == '{' && f[1] == '{') || (f[0] == '}' && f[1] == '}')
+                             ? placeholders(f + 2)
+                             : f[0] == '{' ? placeholder(f + 1) : f[0] == '}' ? invalid : placeholders(f + 1);
+}
+
+/**
+ * Points just after the opening brace of the next placeholder, or at the
+ * terminator when there are no more.
+ */
+constexpr const char *next_placeholder(const char *f) {
+    return *f == 0 ? f
+                   : (f[0] == '{' && f[1] == '{') || (f[0] == '}' && f[1] == '}')
+                             ? next_placeholder(f + 2)
+                             : f[0] == '{' ? f + 1 : next_placeholder(f + 1);
+}
+
+constexpr char spec_kind(const char *f) {
+    return is_digit(*f) ? spec_kind(f + 1) : *f == '}' ? 0 : *f;
+}
+
+/**
+ * Kind of the n-th placeholder, 0 when it has none. Only valid for well
+ * formed strings with more than n placeholders.
+ */
+constexpr char kind_of(const char *f, size_t n) {
+    return n == 0 ? (*f == ':' ? spec_kind(f + 1) : 0)
+                  : kind_of(next_placeholder(*f == ':' ? skip_spec(f + 1) : f + 1), n - 1);
+}
+
+constexpr char kind_of_placeholder(const char *f, size_t n) {
+    return kind_of(next_placeholder(f), n);
+}
+
+/**
+ * Whether a spec of kind k makes sense for an argument of type T, no kind
+ * is always fine.
+ */
+template <typename T> constexpr bool accepts(char k) {
+    return k == 0 ? true
+                  : std::is_same<T, bool>::value ? false
+                  : std::is_same<T, char>::value ? k == 'c'
+                  : std::is_integral<T>::value || std::is_enum<T>::value
+                        ? k == 'd' || k == 'u' || k == 'x' || k == 'X' || k == 'b' || k == 'c'
+                        : std::is_same<T, const char *>::value || std::is_same<T, char *>::value
+                              ? k == 's'
+                              : std::is_pointer<T>::value ? k == 'p' : false;
+}
+
+template <typename... Args> struct kinds;
+
+template <> struct kinds<> {
+    static constexpr bool accepted(const char *f, size_t i) {
+        return true;
+    }
+};
+
+template <typename T, typename... Rest> struct kinds<T, Rest...> {
+    static constexpr bool accepted(const char *f, size_t i) {
+        return accepts<T>(kind_of_placeholder(f, i)) && kinds<Rest...>::accepted(f, i + 1);
+    }
+};
+
+template <typename... Args> kinds<typename std::decay<Args>::type...> types(Args &&...);
+
+template <size_t Expected, size_t Given, bool Accepted> struct check {
+    static_assert(Expected != invalid, "malformed format string");
+    static_assert(Expected == invalid || Expected == Given, "format string and arguments don't match");
+    static_assert(Accepted, "format spec doesn't suit the argument's type");
+    static const bool value = true;
+};
+
+struct writer {
+    char *buffer;
+    size_t size;
+    size_t length;
+
+    void put(char c) {
+        if (length + 1 < size) {
+            buffer[length] = c;
+        }
+        length++;
+    }
+};
+
+struct spec {
+    char kind;
+    bool zero;
+    uint32_t width;
+};
+
+inline const char *literal(writer &w, const char *f) {
+    while (*f != 0) {
+        if (f[0] == '{' && f[1] == '{') {
+            w.put('{');
+            f += 2;
+        } else if (f[0] == '}' && f[1] == '}') {
+            w.put('}');
+            f += 2;
+        } else if (f[0] == '{') {
+            return f + 1;
+        } else {
+            w.put(*f++);
+        }
+    }
+    return f;
+}
+
+inline const char *parse(const char *f, spec &s) {
+    s.kind = 0;
+    s.zero = false;
+    s.width = 0;
+    if (*f == ':') {
+        f++;
+        if (*f == '0') {
+            s.zero = true;
+        }
+        while (is_digit(*f)) {
+            s.width = s.width * 10 + (*f++ - '0');
+        }
+        if (*f != '}') {
+            s.kind = *f++;
+        }
+    }
+    return f + 1;
+}
+
+inline void digits(writer &w, const spec &s, uint64_t value, bool negative, uint32_t base, bool upper) {
+    char scratch[66];
+    uint32_t n = 0;
+    const char *alphabet = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    do {
+        scratch[n++] = alphabet[value % base];
+        value /= base;
+    } while (value != 0);
+    uint32_t total = n + (negative ? 1 : 0);
+    if (negative && s.zero) {
+        w.put('-');
+    }
+    for (; total < s.width; ++total) {
+        w.put(s.zero ? '0' : ' ');
+    }
+    if (negative && !s.zero) {
+        w.put('-');
+    }
+    while (n > 0) {
+        w.put(scratch[--n]);
+    }
+}
+
+inline void number(writer &w, const spec &s, uint64_t value, bool negative) {
+    switch (s.kind) {
+    case 'x':
+        digits(w, s, value, negative, 16, false);
+        break;
+    case 'X':
+        digits(w, s, value, negative, 16, true);
+        break;
+    case 'b':
+        digits(w, s, value, negative, 2, false);
+        break;
+    case 'c':
+        w.put((char)value);
+        break;
+    default:
+        digits(w, s, value, negative, 10, false);
+        break;
+    }
+}
+
+template <typename T> typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type emit(writer &w, const spec &s, T value) {
+    // Hex and binary show the bits, like printf does.
+    if (value < 0 && s.kind != 'x' && s.kind != 'X' && s.kind != 'b') {
+        number(w, s, (uint64_t)0 - (uint64_t)(int64_t)value, true);
+    } else {
+        number(w, s, (uint64_t)(typename std::make_unsigned<T>::type)value, false);
+    }
+}
+
+template <typename T> typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type emit(writer &w, const spec &s, T value) {
+    number(w, s, (uint64_t)value, false);
+}
+
+template <typename T> typename std::enable_if<std::is_enum<T>::value>::type emit(writer &w, const spec &s, T value) {
+    emit(w, s, (typename std::underlying_type<T>::type)value);
+}
+
+inline void emit(writer &w, const spec &s, bool value) {
+    const char *str = value ? "true" : "false";
+    while (*str != 0) {
+        w.put(*str++);
+    }
+}
+
+inline void emit(writer &w, const spec &s, char value) {
+    w.put(value);
+}
+
+inline void emit(writer &w, const spec &s, const char *value) {
+    if (value == nullptr) {
+        value = "(null)";
+    }
+    uint32_t length = 0;
+    for (const char *p = value; *p != 0; ++p) {
+        length++;
+    }
+    for (; length < s.width; ++length) {
+        w.put(' ');
+    }
+    while (*value != 0) {
+        w.put(*value++);
+    }
+}
+
+inline void emit(writer &w, const spec &s, char *value) {
+    emit(w, s, (const char *)value);
+}
+
+template <typename T> void emit(writer &w, const spec &s, T *value) {
+    spec hex = { 'x', true, sizeof(uintptr_t) * 2 };
+    w.put('0');
+    w.put('x');
+    number(w, hex, (uint64_t)(uintptr_t)value, false);
+}
+
+inline void format(writer &w, const char *f) {
+    literal(w, f);
+}
+
+template <typename T, typename... Rest> void format(writer &w, const char *f, const T &value, const Rest &... rest) {
+    f = literal(w, f);
+    if (*f == 0) {
+        return;
+    }
+    spec s;
+    f = parse(f, s);
+    emit(w, s, value);
+    format(w, f, rest...);
+}
+
+} // namespace detail
+
+/**
+ * Like os_snprintf, returns the length the whole output would have been.
+ * Prefer OS_FORMAT, which checks the format.
+ */
+template <typename... Args> size_t format(char *buffer, size_t size, const char *f, const Args &... args) {
+    detail::writer w = { buffer, size, 0 };
+    detail::format(w, f, args...);
+    if (size > 0) {
+        buffer[w.length < size ? w.length : size - 1] = 0;
+    }
+    return w.length;
+}
+
+/**
+ * Format on the stack and write through os_printf. Prefer OS_PRINT, which
+ * checks the format.
+ */
+template <typename... Args> uint32_t print(const char *f, const Args &... args) {
+    char buffer[OS_PRINT_BUFFER_SIZE];
+    format(buffer, sizeof(buffer), f, args...);
+    return os_printf("%s", buffer);
+}
+
+/**
+ * Runtime built format strings go through the regular printf engine.
+ */
+template <typename... Args> uint32_t printf(const char *f, Args... args) {
+    return os_printf(f, args...);
+}
+
+} // namespace os
+
+#endif
+
+#endif
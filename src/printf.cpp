@@ -83,6 +83,15 @@ typedef struct {
     void *arg;
 } out_fct_wrap_type;
 
+// wrapper (used as buffer) for chunked output function type
+typedef struct {
+    void (*fct)(const char *chunk, size_t size, void *arg);
+    void *arg;
+    char *buffer;
+    size_t size;
+    size_t used;
+} out_chunk_wrap_type;
+
 // internal buffer output
 static inline void _out_buffer(char character, void *buffer, size_t idx, size_t maxlen) {
     if (idx < maxlen) {
@@ -106,6 +115,21 @@ static inline void _out_fct(char character, void *buffer, size_t idx, size_t max
     ((out_fct_wrap_type *)buffer)->fct(character, ((out_fct_wrap_type *)buffer)->arg);
 }
 
+// internal chunked output function wrapper, the terminating \0 is dropped
+static inline void _out_chunk(char character, void *buffer, size_t idx, size_t maxlen) {
+    (void)idx;
+    (void)maxlen;
+    out_chunk_wrap_type *chunk = (out_chunk_wrap_type *)buffer;
+    if (character == 0) {
+        return;
+    }
+    chunk->buffer[chunk->used++] = character;
+    if (chunk->used == chunk->size) {
+        chunk->fct(chunk->buffer, chunk->used, chunk->arg);
+        chunk->used = 0;
+    }
+}
+
 // internal strlen
 // \return The length of the string (excluding the terminating 0)
 static inline unsigned int _strlen(const char *str) {
@@ -678,6 +702,16 @@ int os_vfctprintf(void (*out)(char character, void *arg), void *arg, const char
     return ret;
 }
 
+int os_vchunkprintf(void (*out)(const char *chunk, size_t size, void *arg), void *arg, char *buffer, size_t size, const char *format,
+                    va_list va) {
+    out_chunk_wrap_type out_chunk_wrap = { out, arg, buffer, size, 0 };
+    const int ret = _vsnprintf(_out_chunk, (char *)&out_chunk_wrap, (size_t)-1, format, va);
+    if (out_chunk_wrap.used > 0) {
+        out(buffer, out_chunk_wrap.used, arg);
+    }
+    return ret;
+}
+
 int os_fctprintf(void (*out)(char character, void *arg), void *arg, const char *format, ...) {
     va_list va;
     va_start(va, format);
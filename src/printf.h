@@ -70,6 +70,20 @@ int os_vsnprintf(char *buffer, size_t count, const char *format, va_list va);
 int os_fctprintf(void (*out)(char character, void *arg), void *arg, const char *format, ...);
 int os_vfctprintf(void (*out)(char character, void *arg), void *arg, const char *format, va_list va);
 
+/**
+ * printf with chunked output function
+ * Formats into buffer and hands it to the output function whenever it fills up and once more at the end, so the output
+ * function is called once per chunk rather than once per character
+ * \param out An output function which takes a chunk of characters, its size and an argument pointer
+ * \param arg An argument pointer for user data passed to output function
+ * \param buffer Scratch space for one chunk
+ * \param size The size of buffer, MUST be at least 1
+ * \param format A string that specifies the format of the output
+ * \return The number of characters that are sent to the output function, not counting the terminating null character
+ */
+int os_vchunkprintf(void (*out)(const char *chunk, size_t size, void *arg), void *arg, char *buffer, size_t size, const char *format,
+                    va_list va);
+
 #ifdef __cplusplus
 }
 #endif
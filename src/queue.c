@@ -31,6 +31,63 @@ static os_task_t *blocked_deq(os_queue_t *queue) {
     return task;
 }
 
+#if defined(OS_CONFIG_QUEUE_STATS)
+
+static uint32_t *queue_stamps(os_queue_t *queue) {
+    return (uint32_t *)&queue->messages[queue->size];
+}
+
+#endif
+
+static void stats_enqueued(os_queue_t *queue, uint16_t slot) {
+#if defined(OS_CONFIG_QUEUE_STATS)
+    queue_stamps(queue)[slot] = os_micros();
+    queue->stats.enqueued++;
+    if (queue->number > queue->stats.highwater) {
+        queue->stats.highwater = queue->number;
+    }
+#endif
+}
+
+static void stats_dequeued(os_queue_t *queue, uint16_t slot) {
+#if defined(OS_CONFIG_QUEUE_STATS)
+    uint32_t latency = os_micros() - queue_stamps(queue)[slot];
+    queue->stats.dequeued++;
+    queue->stats.latency_total += latency;
+    if (latency > queue->stats.latency_max) {
+        queue->stats.latency_max = latency;
+    }
+#endif
+}
+
+static void stats_handed_off(os_queue_t *queue) {
+#if defined(OS_CONFIG_QUEUE_STATS)
+    queue->stats.enqueued++;
+    queue->stats.dequeued++;
+#endif
+}
+
+static void stats_blocked(os_queue_t *queue) {
+#if defined(OS_CONFIG_QUEUE_STATS)
+    if (queue->status == OS_QUEUE_BLOCKED_SEND) {
+        queue->stats.full_blocks++;
+    } else {
+        queue->stats.empty_blocks++;
+    }
+#endif
+}
+
+static void registry_add(os_queue_t *queue) {
+    // Creating the same queue again mustn't link it twice.
+    for (os_queue_t *iter = osg.queues; iter != NULL; iter = iter->next) {
+        if (iter == queue) {
+            return;
+        }
+    }
+    queue->next = osg.queues;
+    osg.queues = queue;
+}
+
 os_status_t osi_queue_create(os_queue_t *queue, os_queue_definition_t *def) {
     queue->def = def;
     queue->size = def->size;
@@ -43,6 +100,10 @@ os_status_t osi_queue_create(os_queue_t *queue, os_queue_definition_t *def) {
     for (uint16_t i = 0; i < queue->size; ++i) {
         queue->messages[i] = NULL;
     }
+#if defined(OS_CONFIG_QUEUE_STATS)
+    memset(&queue->stats, 0, sizeof(queue->stats));
+#endif
+    registry_add(queue);
     return OSS_SUCCESS;
 }
 
@@ -59,17 +120,10 @@ os_tuple_t osi_queue_enqueue_isr(os_queue_t *queue, void *message) {
             os_tuple_t *receive_rv = osi_task_stacked_return_tuple(blocked_receiver);
             receive_rv->status = OSS_SUCCESS;
             receive_rv->value.ptr = message;
+            stats_handed_off(queue);
 
-            // osi_printf("osh[queue-enq-isr]: osi-dispatch-or-queue\n");
-
-            osi_dispatch_or_queue(blocked_receiver);
-
-// Manually trigger this since we're inside an arbitrary ISR this won't
-// necessarily happen. Our SVC handler will check for scheduled/running
-// changes and do the switch w/o the PendSV.
-#if defined(__SAMD21__) || defined(__SAMD51__)
-            SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
-#endif
+            // We're inside an arbitrary ISR, so the switch is left to PendSV.
+            osi_dispatch_isr(blocked_receiver);
 
             return tuple;
         }
@@ -84,6 +138,7 @@ os_tuple_t osi_queue_enqueue_isr(os_queue_t *queue, void *message) {
     queue->status = OS_QUEUE_FINE;
     queue->messages[queue->first] = message;
     queue->number++;
+    stats_enqueued(queue, queue->first);
     if (++queue->first == queue->size) {
         queue->first = 0U;
     }
@@ -91,6 +146,45 @@ os_tuple_t osi_queue_enqueue_isr(os_queue_t *queue, void *message) {
     return tuple;
 }
 
+os_tuple_t osi_queue_dequeue_isr(os_queue_t *queue) {
+    os_tuple_t tuple;
+    tuple.status = OSS_SUCCESS;
+    tuple.value.ptr = NULL;
+
+    if (queue->number == 0) {
+        tuple.status = OSS_ERROR_MEM;
+        return tuple;
+    }
+
+    tuple.value.ptr = queue->messages[queue->last];
+    stats_dequeued(queue, queue->last);
+    if (++queue->last == queue->size) {
+        queue->last = 0;
+    }
+    queue->number--;
+
+    // Is somebody waiting to send a message?
+    if (queue->blocked.tasks != NULL && queue->status == OS_QUEUE_BLOCKED_SEND) {
+        os_task_t *blocked_sender = blocked_deq(queue);
+
+        queue->messages[queue->first] = blocked_sender->c.message;
+        queue->number++;
+        stats_enqueued(queue, queue->first);
+        if (++queue->first == queue->size) {
+            queue->first = 0U;
+        }
+        blocked_sender->c.message = NULL;
+
+        os_tuple_t *send_rv = osi_task_stacked_return_tuple(blocked_sender);
+        send_rv->status = OSS_SUCCESS;
+        send_rv->value.ptr = NULL;
+
+        osi_dispatch_isr(blocked_sender);
+    }
+
+    return tuple;
+}
+
 os_status_t osi_queue_enqueue(os_queue_t *queue, void *message, uint32_t to) {
     os_task_t *running = os_task_self();
 
@@ -105,6 +199,7 @@ os_status_t osi_queue_enqueue(os_queue_t *queue, void *message, uint32_t to) {
             os_tuple_t *receive_rv = osi_task_stacked_return_tuple(blocked_receiver);
             receive_rv->status = OSS_SUCCESS;
             receive_rv->value.ptr = message;
+            stats_handed_off(queue);
 
             // osi_printf("osh[queue-enq]: osi-dispatch-or-queue\n");
 
@@ -125,6 +220,7 @@ os_status_t osi_queue_enqueue(os_queue_t *queue, void *message, uint32_t to) {
 
         // Block until somebody takes one, freeing space.
         queue->status = OS_QUEUE_BLOCKED_SEND;
+        stats_blocked(queue);
         blocked_enq(queue, os_task_self());
         svc_block(to, OS_TASK_FLAG_QUEUE);
 
@@ -135,6 +231,7 @@ os_status_t osi_queue_enqueue(os_queue_t *queue, void *message, uint32_t to) {
     queue->status = OS_QUEUE_FINE;
     queue->messages[queue->first] = message;
     queue->number++;
+    stats_enqueued(queue, queue->first);
     if (++queue->first == queue->size) {
         queue->first = 0U;
     }
@@ -148,6 +245,7 @@ os_status_t osi_queue_dequeue(os_queue_t *queue, void **message, uint32_t to) {
 
     if (queue->number > 0) {
         *message = queue->messages[queue->last];
+        stats_dequeued(queue, queue->last);
         if (++queue->last == queue->size) {
             queue->last = 0;
         }
@@ -158,10 +256,11 @@ os_status_t osi_queue_dequeue(os_queue_t *queue, void **message, uint32_t to) {
             os_task_t *blocked_sender = blocked_deq(queue);
 
             queue->messages[queue->first] = blocked_sender->c.message;
+            queue->number++;
+            stats_enqueued(queue, queue->first);
             if (++queue->first == queue->size) {
                 queue->first = 0U;
             }
-            queue->number++;
             blocked_sender->c.message = NULL;
 
             os_tuple_t *send_rv = osi_task_stacked_return_tuple(blocked_sender);
@@ -181,7 +280,36 @@ os_status_t osi_queue_dequeue(os_queue_t *queue, void **message, uint32_t to) {
 
     // Block for to ms or until a message comes in.
     queue->status = OS_QUEUE_BLOCKED_RECEIVE;
+    stats_blocked(queue);
     blocked_enq(queue, os_task_self());
     svc_block(to, OS_TASK_FLAG_QUEUE);
     return OSS_ERROR_TO;
 }
+
+os_queue_t *os_queue_iterate(os_queue_t *iter) {
+    if (iter == NULL) {
+        return osg.queues;
+    }
+    return iter->next;
+}
+
+#if defined(OS_CONFIG_QUEUE_STATS)
+
+os_status_t os_queue_stats_get(os_queue_t *queue, os_queue_stats_t *stats) {
+    OS_LOCK();
+    memcpy(stats, &queue->stats, sizeof(os_queue_stats_t));
+    OS_UNLOCK();
+
+    return OSS_SUCCESS;
+}
+
+os_status_t os_queue_stats_reset(os_queue_t *queue) {
+    OS_LOCK();
+    memset(&queue->stats, 0, sizeof(os_queue_stats_t));
+    queue->stats.highwater = queue->number;
+    OS_UNLOCK();
+
+    return OSS_SUCCESS;
+}
+
+#endif
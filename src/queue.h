@@ -22,6 +22,7 @@ os_status_t osi_queue_create(os_queue_t *queue, os_queue_definition_t *def);
 os_status_t osi_queue_enqueue(os_queue_t *queue, void *message, uint32_t to);
 os_status_t osi_queue_dequeue(os_queue_t *queue, void **message, uint32_t to);
 os_tuple_t osi_queue_enqueue_isr(os_queue_t *queue, void *message);
+os_tuple_t osi_queue_dequeue_isr(os_queue_t *queue);
 
 #if defined(__cplusplus)
 }
@@ -14,16 +14,212 @@
 #include "os.h"
 #include "internal.h"
 
-#define OS_RWLOCK_DESIRED_NONE  0
-#define OS_RWLOCK_DESIRED_READ  1
-#define OS_RWLOCK_DESIRED_WRITE 2
+#define OS_RWLOCK_DESIRED_NONE        0
+#define OS_RWLOCK_DESIRED_READ        1
+#define OS_RWLOCK_DESIRED_WRITE       2
+#define OS_RWLOCK_DESIRED_UPGRADEABLE 3
+#define OS_RWLOCK_DESIRED_UPGRADE     4
 
 static void blocked_enq(os_rwlock_t *rwlock, os_task_t *task) {
+    OS_LOCK_STATS_BLOCKED(&rwlock->stats, task);
     blocked_append(&rwlock->blocked, task);
     OS_ASSERT(task->rwlock == NULL);
     task->rwlock = rwlock;
 }
 
+static uint32_t rwlock_policy(os_rwlock_t *rwlock) {
+    return rwlock->flags & OS_RWLOCK_FLAG_POLICY_MASK;
+}
+
+static bool rwlock_is_waiting(os_rwlock_t *rwlock, uint32_t desired) {
+    for (os_task_t *iter = rwlock->blocked.tasks; iter != NULL; iter = iter->nblocked) {
+        if (iter->c.desired == desired) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool rwlock_upgrade_pending(os_rwlock_t *rwlock) {
+    os_task_t *upgrader = rwlock->upgrader;
+    return upgrader != NULL && upgrader->rwlock == rwlock && upgrader->c.desired == OS_RWLOCK_DESIRED_UPGRADE;
+}
+
+/**
+ * Readers may jump ahead of waiting writers only when the lock prefers
+ * readers, otherwise they queue up behind them. Nobody gets in while the
+ * upgrader is waiting for readers to drain.
+ */
+static bool rwlock_can_read(os_rwlock_t *rwlock) {
+    if (rwlock->writers > 0) {
+        return false;
+    }
+    if (rwlock_upgrade_pending(rwlock)) {
+        return false;
+    }
+    if (rwlock_policy(rwlock) == OS_RWLOCK_FLAG_PREFER_READERS) {
+        return true;
+    }
+    return !rwlock_is_waiting(rwlock, OS_RWLOCK_DESIRED_WRITE);
+}
+
+/**
+ * The task's read of rwlock, or with a NULL rwlock a free slot. NULL if
+ * there's no such read or every slot is taken.
+ */
+static os_rwlock_read_t *rwlock_read_find(os_task_t *task, os_rwlock_t *rwlock) {
+    for (uint32_t i = 0; i < OS_TASK_RWLOCK_READS_MAX; ++i) {
+        if (task->rwlock_reads[i].rwlock == rwlock) {
+            return &task->rwlock_reads[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Tracks reads per task so that nested reads by the same task just bump a
+ * counter. Callers have already checked there's a free slot.
+ */
+static void rwlock_read_held(os_rwlock_t *rwlock, os_task_t *task) {
+    os_rwlock_read_t *read = rwlock_read_find(task, NULL);
+    OS_ASSERT(read != NULL);
+    read->rwlock = rwlock;
+    read->depth = 1;
+    rwlock->readers++;
+}
+
+/**
+ * Turns the upgrader's read into a write, only valid once the upgrader is
+ * the last reader.
+ */
+static void rwlock_upgrade(os_rwlock_t *rwlock, os_task_t *task) {
+    OS_ASSERT(rwlock->upgrader == task);
+    OS_ASSERT(rwlock->readers == 1);
+    OS_ASSERT(rwlock->writers == 0);
+
+    rwlock->readers = 0;
+    rwlock->upgrader = NULL;
+    rwlock->writers++;
+    rwlock->writer = task;
+    os_rwlock_read_t *read = rwlock_read_find(task, rwlock);
+    read->rwlock = NULL;
+    read->depth = 0;
+    OS_LOCK_STATS_HELD(&rwlock->stats, task);
+}
+
+/**
+ * Wakes the highest priority waiting writer, the first one to block wins ties.
+ */
+static bool rwlock_wake_writer(os_rwlock_t *rwlock) {
+    os_task_t *writer = NULL;
+    for (os_task_t *iter = rwlock->blocked.tasks; iter != NULL; iter = iter->nblocked) {
+        if (iter->c.desired == OS_RWLOCK_DESIRED_WRITE) {
+            if (writer == NULL || iter->priority > writer->priority) {
+                writer = iter;
+            }
+        }
+    }
+
+    if (writer == NULL) {
+        return false;
+    }
+
+    blocked_remove(&rwlock->blocked, writer);
+    writer->c.desired = OS_RWLOCK_DESIRED_NONE;
+    rwlock->writers++;
+    rwlock->writer = writer;
+    OS_LOCK_STATS_WOKEN(&rwlock->stats, writer);
+    OS_LOCK_STATS_HELD(&rwlock->stats, writer);
+    osi_task_set_stacked_return(writer, OSS_SUCCESS);
+    osi_dispatch_or_queue(writer);
+
+    return true;
+}
+
+/**
+ * Wakes the upgrader if it's waiting and the other readers have drained.
+ */
+static bool rwlock_wake_upgrader(os_rwlock_t *rwlock) {
+    if (!rwlock_upgrade_pending(rwlock) || rwlock->readers != 1) {
+        return false;
+    }
+
+    os_task_t *upgrader = rwlock->upgrader;
+
+    blocked_remove(&rwlock->blocked, upgrader);
+    upgrader->c.desired = OS_RWLOCK_DESIRED_NONE;
+    OS_LOCK_STATS_WOKEN(&rwlock->stats, upgrader);
+    rwlock_upgrade(rwlock, upgrader);
+    osi_task_set_stacked_return(upgrader, OSS_SUCCESS);
+    osi_dispatch_or_queue(upgrader);
+
+    return true;
+}
+
+/**
+ * Wakes every waiting reader, along with one upgradeable reader if there's
+ * no upgrader already. They're all made runnable and then the highest
+ * priority one is dispatched so it gets a turn as soon as it should.
+ */
+static uint32_t rwlock_wake_readers(os_rwlock_t *rwlock) {
+    os_task_t *highest = NULL;
+    os_task_t *previous = NULL;
+    os_task_t *iter = rwlock->blocked.tasks;
+    uint32_t woken = 0;
+
+    while (iter != NULL) {
+        os_task_t *next = iter->nblocked;
+        bool upgradeable = iter->c.desired == OS_RWLOCK_DESIRED_UPGRADEABLE && rwlock->upgrader == NULL;
+        if (iter->c.desired == OS_RWLOCK_DESIRED_READ || upgradeable) {
+            if (previous == NULL) {
+                rwlock->blocked.tasks = next;
+            } else {
+                previous->nblocked = next;
+            }
+            iter->nblocked = NULL;
+            iter->c.desired = OS_RWLOCK_DESIRED_NONE;
+            OS_LOCK_STATS_WOKEN(&rwlock->stats, iter);
+            osi_task_set_stacked_return(iter, OSS_SUCCESS);
+            rwlock_read_held(rwlock, iter);
+            if (upgradeable) {
+                rwlock->upgrader = iter;
+            }
+            woken++;
+
+            if (highest == NULL || iter->priority > highest->priority) {
+                if (highest != NULL && !os_task_status_is_running(highest->status)) {
+                    osi_task_status_set(highest, OS_TASK_STATUS_IDLE);
+                }
+                highest = iter;
+            } else if (!os_task_status_is_running(iter->status)) {
+                osi_task_status_set(iter, OS_TASK_STATUS_IDLE);
+            }
+        } else {
+            previous = iter;
+        }
+        iter = next;
+    }
+
+    if (highest != NULL) {
+        osi_dispatch_or_queue(highest);
+    }
+
+    return woken;
+}
+
+static os_status_t rwlock_release(os_rwlock_t *rwlock, os_task_t *task);
+
+static void registry_add(os_rwlock_t *rwlock) {
+    // Creating the same rwlock again mustn't link it twice.
+    for (os_rwlock_t *iter = osg.rwlocks; iter != NULL; iter = iter->next) {
+        if (iter == rwlock) {
+            return;
+        }
+    }
+    rwlock->next = osg.rwlocks;
+    osg.rwlocks = rwlock;
+}
+
 os_status_t osi_rwlock_create(os_rwlock_t *rwlock, os_rwlock_definition_t *def) {
     rwlock->def = def;
     rwlock->blocked.type = 0;
@@ -32,18 +228,37 @@ os_status_t osi_rwlock_create(os_rwlock_t *rwlock, os_rwlock_definition_t *def)
     rwlock->writers = 0;
     rwlock->flags = def->flags;
     rwlock->writer = NULL;
+    rwlock->upgrader = NULL;
+    OS_LOCK_STATS_CREATED(&rwlock->stats, def->name, OS_LOCK_KIND_RWLOCK);
+    registry_add(rwlock);
     return OSS_SUCCESS;
 }
 
 os_status_t osi_rwlock_acquire_read(os_rwlock_t *rwlock, uint32_t to) {
     os_task_t *task = os_task_self();
 
-    // TODO: Allow tasks to have more than one rwlock.
     OS_ASSERT(task->rwlock == NULL || task->rwlock == rwlock);
 
+    // Nested reads always succeed, otherwise a waiting writer would deadlock
+    // the task with itself.
+    os_rwlock_read_t *read = rwlock_read_find(task, rwlock);
+    if (read != NULL) {
+        if (read->depth == UINT16_MAX) {
+            return OSS_ERROR;
+        }
+        read->depth++;
+        return OSS_SUCCESS;
+    }
+
+    // An untracked read could deadlock behind a writer the same way.
+    if (rwlock->writer == task || rwlock_read_find(task, NULL) == NULL) {
+        return OSS_ERROR_INVALID;
+    }
+
     // Check for an easy acquire.
-    if (rwlock->writers == 0) {
-        rwlock->readers++;
+    if (rwlock_can_read(rwlock)) {
+        rwlock_read_held(rwlock, task);
+        OS_LOCK_STATS_ACQUIRED(&rwlock->stats);
         return OSS_SUCCESS;
     }
 
@@ -61,13 +276,19 @@ os_status_t osi_rwlock_acquire_read(os_rwlock_t *rwlock, uint32_t to) {
 os_status_t osi_rwlock_acquire_write(os_rwlock_t *rwlock, uint32_t to) {
     os_task_t *task = os_task_self();
 
-    // TODO: Allow tasks to have more than one rwlock.
     OS_ASSERT(task->rwlock == NULL || task->rwlock == rwlock);
 
+    // Waiting on our own read would never finish, use an upgradeable read.
+    if (rwlock_read_find(task, rwlock) != NULL || rwlock->writer == task) {
+        return OSS_ERROR_INVALID;
+    }
+
     // Check for an easy acquire.
     if (rwlock->readers == 0 && rwlock->writers == 0) {
         rwlock->writers++;
         rwlock->writer = task;
+        OS_LOCK_STATS_ACQUIRED(&rwlock->stats);
+        OS_LOCK_STATS_HELD(&rwlock->stats, task);
         return OSS_SUCCESS;
     }
 
@@ -82,52 +303,176 @@ os_status_t osi_rwlock_acquire_write(os_rwlock_t *rwlock, uint32_t to) {
     return OSS_ERROR_TO;
 }
 
-os_status_t osi_rwlock_release(os_rwlock_t *rwlock) {
+os_status_t osi_rwlock_acquire_upgradeable(os_rwlock_t *rwlock, uint32_t to) {
     os_task_t *task = os_task_self();
 
-    OS_ASSERT(rwlock->readers > 0 || rwlock->writers == 1);
+    OS_ASSERT(task->rwlock == NULL || task->rwlock == rwlock);
 
-    if (rwlock->readers > 0) {
-        rwlock->readers--;
+    os_rwlock_read_t *read = rwlock_read_find(task, rwlock);
+    if (read != NULL) {
+        // Plain readers can't become the upgrader, two of them upgrading
+        // would wait on each other forever.
+        if (rwlock->upgrader != task) {
+            return OSS_ERROR_INVALID;
+        }
+        if (read->depth == UINT16_MAX) {
+            return OSS_ERROR;
+        }
+        read->depth++;
+        return OSS_SUCCESS;
+    }
+
+    // The upgrader's read has to be tracked so we know when it's the last one.
+    if (rwlock->writer == task || rwlock_read_find(task, NULL) == NULL) {
+        return OSS_ERROR_INVALID;
+    }
+
+    // Check for an easy acquire.
+    if (rwlock->upgrader == NULL && rwlock_can_read(rwlock)) {
+        rwlock_read_held(rwlock, task);
+        rwlock->upgrader = task;
+        OS_LOCK_STATS_ACQUIRED(&rwlock->stats);
+        return OSS_SUCCESS;
+    }
+
+    if (to == 0) {
+        return OSS_ERROR_TO;
+    }
+
+    // Block until somebody releases.
+    task->c.desired = OS_RWLOCK_DESIRED_UPGRADEABLE;
+    blocked_enq(rwlock, task);
+    svc_block(to, OS_TASK_FLAG_RWLOCK);
+    return OSS_ERROR_TO;
+}
+
+os_status_t osi_rwlock_upgrade(os_rwlock_t *rwlock, uint32_t to) {
+    os_task_t *task = os_task_self();
+
+    os_rwlock_read_t *read = rwlock_read_find(task, rwlock);
+    if (rwlock->upgrader != task || read == NULL) {
+        return OSS_ERROR_INVALID;
+    }
+
+    // Nested code may still be relying on reading, so only the outermost
+    // upgradeable read can be upgraded.
+    if (read->depth != 1) {
+        return OSS_ERROR_INVALID;
+    }
+
+    // Check for an easy upgrade, we're the only reader.
+    if (rwlock->readers == 1) {
+        rwlock_upgrade(rwlock, task);
+        return OSS_SUCCESS;
+    }
+
+    if (to == 0) {
+        return OSS_ERROR_TO;
+    }
+
+    // Block until the other readers drain, our read keeps writers and other
+    // upgraders out and new readers queue up behind us.
+    task->c.desired = OS_RWLOCK_DESIRED_UPGRADE;
+    blocked_enq(rwlock, task);
+    svc_block(to, OS_TASK_FLAG_RWLOCK);
+    return OSS_ERROR_TO;
+}
+
+os_status_t osi_rwlock_release(os_rwlock_t *rwlock) {
+    return rwlock_release(rwlock, os_task_self());
+}
+
+os_status_t osi_rwlock_abandon(os_rwlock_t *rwlock, os_task_t *task) {
+    if (rwlock->writer == task) {
+        return rwlock_release(rwlock, task);
+    }
+    os_rwlock_read_t *read = rwlock_read_find(task, rwlock);
+    if (read != NULL) {
+        // However deep the reads were, this is the last.
+        read->depth = 1;
+        return rwlock_release(rwlock, task);
     }
+    return OSS_SUCCESS;
+}
+
+static os_status_t rwlock_release(os_rwlock_t *rwlock, os_task_t *task) {
+    bool was_writing = false;
+
+    OS_ASSERT(rwlock->readers > 0 || rwlock->writers == 1);
 
     if (rwlock->writers > 0) {
         OS_ASSERT(rwlock->writer == task);
         rwlock->writer = NULL;
         rwlock->writers--;
+        was_writing = true;
+        OS_LOCK_STATS_RELEASED(&rwlock->stats);
+    } else {
+        os_rwlock_read_t *read = rwlock_read_find(task, rwlock);
+        if (read == NULL) {
+            return OSS_ERROR_INVALID;
+        }
+        OS_ASSERT(read->depth > 0);
+        if (--read->depth > 0) {
+            return OSS_SUCCESS;
+        }
+        read->rwlock = NULL;
+        if (rwlock->upgrader == task) {
+            rwlock->upgrader = NULL;
+        }
+        rwlock->readers--;
     }
 
     /* Is somebody waiting for this rwlock? */
-    if (rwlock->blocked.tasks != NULL) {
-        os_task_t *task = rwlock->blocked.tasks;
-        if (rwlock->readers == 0 && task->c.desired == OS_RWLOCK_DESIRED_WRITE) {
-            rwlock->blocked.tasks = task->nblocked;
-            task->nblocked = NULL;
-            task->c.desired = OS_RWLOCK_DESIRED_NONE;
-            rwlock->writers++;
-            rwlock->writer = task;
-            osi_task_set_stacked_return(task, OSS_SUCCESS);
-            osi_dispatch_or_queue(task);
-        } else {
-            os_task_t *previous = NULL;
-            for (os_task_t *iter = rwlock->blocked.tasks; iter != NULL; iter = iter->nblocked) {
-                if (iter->c.desired == OS_RWLOCK_DESIRED_READ) {
-                    if (previous == NULL) {
-                        rwlock->blocked.tasks = iter->nblocked;
-                    } else {
-                        previous->nblocked = iter->nblocked;
-                    }
-                    iter->nblocked = NULL;
-                    iter->c.desired = OS_RWLOCK_DESIRED_NONE;
-                    osi_task_set_stacked_return(iter, OSS_SUCCESS);
-                    osi_task_status_set(iter, OS_TASK_STATUS_IDLE);
-                    rwlock->readers++;
-                } else {
-                    previous = iter;
-                }
-            }
+    if (rwlock->blocked.tasks == NULL) {
+        return OSS_SUCCESS;
+    }
+
+    // A waiting upgrade goes before anybody else, nobody else can get in
+    // until the upgrader is done anyway.
+    if (rwlock_wake_upgrader(rwlock)) {
+        return OSS_SUCCESS;
+    }
+    if (rwlock_upgrade_pending(rwlock)) {
+        return OSS_SUCCESS;
+    }
+
+    // Phase fair locks alternate, so the end of a write phase lets every
+    // reader that queued up during it in and the end of a read phase lets a
+    // writer in.
+    bool prefer_readers = false;
+    switch (rwlock_policy(rwlock)) {
+    case OS_RWLOCK_FLAG_PREFER_WRITERS:
+        prefer_readers = false;
+        break;
+    case OS_RWLOCK_FLAG_PHASE_FAIR:
+        prefer_readers = was_writing;
+        break;
+    default:
+        prefer_readers = true;
+        break;
+    }
+
+    if (prefer_readers || !rwlock_is_waiting(rwlock, OS_RWLOCK_DESIRED_WRITE)) {
+        if (rwlock_wake_readers(rwlock) > 0) {
+            return OSS_SUCCESS;
         }
     }
 
+    if (rwlock->readers == 0) {
+        rwlock_wake_writer(rwlock);
+    }
+
     return OSS_SUCCESS;
 }
+
+os_rwlock_t *os_rwlock_iterate(os_rwlock_t *iter) {
+    if (iter == NULL) {
+        return osg.rwlocks;
+    }
+    return iter->next;
+}
+
+uint16_t osi_rwlock_read_depth(os_rwlock_t *rwlock, os_task_t *task) {
+    os_rwlock_read_t *read = rwlock_read_find(task, rwlock);
+    return read != NULL ? read->depth : 0;
+}
@@ -21,8 +21,20 @@ extern "C" {
 os_status_t osi_rwlock_create(os_rwlock_t *rwlock, os_rwlock_definition_t *def);
 os_status_t osi_rwlock_acquire_read(os_rwlock_t *rwlock, uint32_t to);
 os_status_t osi_rwlock_acquire_write(os_rwlock_t *rwlock, uint32_t to);
+os_status_t osi_rwlock_acquire_upgradeable(os_rwlock_t *rwlock, uint32_t to);
+os_status_t osi_rwlock_upgrade(os_rwlock_t *rwlock, uint32_t to);
 os_status_t osi_rwlock_release(os_rwlock_t *rwlock);
 
+/**
+ * Release whatever task holds, its write or all of its nested reads.
+ */
+os_status_t osi_rwlock_abandon(os_rwlock_t *rwlock, os_task_t *task);
+
+/**
+ * How deeply task is reading rwlock, 0 when it isn't.
+ */
+uint16_t osi_rwlock_read_depth(os_rwlock_t *rwlock, os_task_t *task);
+
 #if defined(__cplusplus)
 }
 #endif
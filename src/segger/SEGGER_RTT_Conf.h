@@ -77,7 +77,7 @@ Revision: $Rev: 13430 $
 #define SEGGER_RTT_BUFFER_SECTION                 ".rtt.buffers"
 
 #if !defined(SEGGER_RTT_MAX_NUM_UP_BUFFERS)
-#define SEGGER_RTT_MAX_NUM_UP_BUFFERS             (2)     // Max. number of up-buffers (T->H) available on this target    (Default: 3)
+#define SEGGER_RTT_MAX_NUM_UP_BUFFERS             (3)     // Max. number of up-buffers (T->H) available on this target    (Default: 3)
 #endif
 
 #if !defined(SEGGER_RTT_MAX_NUM_DOWN_BUFFERS)
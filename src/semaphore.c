@@ -31,12 +31,25 @@ static os_task_t *blocked_deq(os_semaphore_t *semaphore) {
     return task;
 }
 
+static void registry_add(os_semaphore_t *semaphore) {
+    // Creating the same semaphore again mustn't link it twice.
+    for (os_semaphore_t *iter = osg.semaphores; iter != NULL; iter = iter->next) {
+        if (iter == semaphore) {
+            return;
+        }
+    }
+    semaphore->next = osg.semaphores;
+    osg.semaphores = semaphore;
+}
+
 os_status_t osi_semaphore_create(os_semaphore_t *semaphore, os_semaphore_definition_t *def) {
     semaphore->def = def;
     semaphore->tokens = def->tokens;
     semaphore->blocked.type = 0;
     semaphore->blocked.tasks = NULL;
     semaphore->flags = def->flags;
+    OS_LOCK_STATS_CREATED(&semaphore->stats, def->name, OS_LOCK_KIND_SEMAPHORE);
+    registry_add(semaphore);
     return OSS_SUCCESS;
 }
 
@@ -49,6 +62,7 @@ os_status_t osi_semaphore_acquire(os_semaphore_t *semaphore, uint32_t to) {
     // Check for an easy acquire.
     if (semaphore->tokens > 0) {
         semaphore->tokens--;
+        OS_LOCK_STATS_ACQUIRED(&semaphore->stats);
         return OSS_SUCCESS;
     }
 
@@ -57,15 +71,42 @@ os_status_t osi_semaphore_acquire(os_semaphore_t *semaphore, uint32_t to) {
     }
 
     // Block until somebody releases.
+    OS_LOCK_STATS_BLOCKED(&semaphore->stats, task);
     blocked_enq(semaphore, task);
     svc_block(to, OS_TASK_FLAG_SEMAPHORE);
     return OSS_ERROR_TO;
 }
 
+os_status_t osi_semaphore_acquire_isr(os_semaphore_t *semaphore) {
+    if (semaphore->tokens > 0) {
+        semaphore->tokens--;
+        OS_LOCK_STATS_ACQUIRED(&semaphore->stats);
+        return OSS_SUCCESS;
+    }
+
+    return OSS_ERROR_TO;
+}
+
+os_status_t osi_semaphore_release_isr(os_semaphore_t *semaphore) {
+    /* Is somebody waiting for this semaphore? */
+    if (semaphore->blocked.tasks != NULL) {
+        os_task_t *blocked_task = blocked_deq(semaphore);
+        OS_LOCK_STATS_WOKEN(&semaphore->stats, blocked_task);
+        osi_task_set_stacked_return(blocked_task, OSS_SUCCESS);
+        osi_dispatch_isr(blocked_task);
+        return OSS_SUCCESS;
+    }
+
+    semaphore->tokens++;
+
+    return OSS_SUCCESS;
+}
+
 os_status_t osi_semaphore_release(os_semaphore_t *semaphore) {
     /* Is somebody waiting for this semaphore? */
     if (semaphore->blocked.tasks != NULL) {
         os_task_t *blocked_task = blocked_deq(semaphore);
+        OS_LOCK_STATS_WOKEN(&semaphore->stats, blocked_task);
         osi_task_set_stacked_return(blocked_task, OSS_SUCCESS);
         osi_dispatch_or_queue(blocked_task);
         return OSS_SUCCESS;
@@ -75,3 +116,10 @@ os_status_t osi_semaphore_release(os_semaphore_t *semaphore) {
 
     return OSS_SUCCESS;
 }
+
+os_semaphore_t *os_semaphore_iterate(os_semaphore_t *iter) {
+    if (iter == NULL) {
+        return osg.semaphores;
+    }
+    return iter->next;
+}
@@ -21,6 +21,8 @@ extern "C" {
 os_status_t osi_semaphore_create(os_semaphore_t *semaphore, os_semaphore_definition_t *def);
 os_status_t osi_semaphore_acquire(os_semaphore_t *semaphore, uint32_t to);
 os_status_t osi_semaphore_release(os_semaphore_t *semaphore);
+os_status_t osi_semaphore_acquire_isr(os_semaphore_t *semaphore);
+os_status_t osi_semaphore_release_isr(os_semaphore_t *semaphore);
 
 #if defined(__cplusplus)
 }
@@ -16,6 +16,129 @@
 #include "syscalls.h"
 #include "platform.h"
 
+#if defined(OS_CONFIG_SVC_STATS)
+
+#define OS_SVC_NAME(f) #f,
+
+static os_svc_stats_t svc_stats[OS_SVC_COUNT];
+
+static const char *svc_names[OS_SVC_COUNT] = { "svc_invalid", OS_SVC_TABLE(OS_SVC_NAME) };
+
+static void svc_stats_record(uint32_t number, uint32_t elapsed) {
+    os_svc_stats_t *stats = &svc_stats[number];
+    uint32_t bucket = 31 - __builtin_clz(elapsed | 1);
+    if (bucket >= OS_SVC_STATS_BUCKETS) {
+        bucket = OS_SVC_STATS_BUCKETS - 1;
+    }
+    stats->calls++;
+    stats->cycles += elapsed;
+    stats->buckets[bucket]++;
+}
+
+typedef uint64_t (*svc_raw_handler_t)(uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4);
+
+/**
+ * Every return value we use fits in r0 and r1, which is also how a uint64_t
+ * comes back, so one signature works for all of them.
+ */
+static uint64_t svc_measure(uint32_t number, os_svc_handler_t handler, uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4) {
+    uint32_t started = osi_platform_cycles();
+    uint64_t value = ((svc_raw_handler_t)handler)(a1, a2, a3, a4);
+    svc_stats_record(number, osi_platform_cycles() - started);
+    return value;
+}
+
+#define OS_SVC_MEASURED(f)                                                                                                                 \
+    static uint64_t svc_measured_##f(uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4) {                                                 \
+        return svc_measure(OS_SVC_##f, (os_svc_handler_t)&f, a1, a2, a3, a4);                                                              \
+    }
+
+OS_SVC_TABLE(OS_SVC_MEASURED)
+
+#define OS_SVC_HANDLER(f) (os_svc_handler_t)&svc_measured_##f,
+
+#else
+
+#define OS_SVC_HANDLER(f) (os_svc_handler_t)&f,
+
+#endif
+
+uint32_t osi_svc_invalid(void) {
+#if defined(OS_CONFIG_SVC_STATS)
+    svc_stats_record(OS_SVC_NONE, 0);
+#endif
+    return OSS_ERROR_INVALID;
+}
+
+_Static_assert(OS_SVC_COUNT <= OS_SVC_USER, "kernel SVC numbers overlap user SVC numbers");
+
+const os_svc_handler_t osi_svc_table[OS_SVC_COUNT] = { NULL, OS_SVC_TABLE(OS_SVC_HANDLER) };
+
+const uint32_t osi_svc_table_size = OS_SVC_COUNT;
+
+os_svc_handler_t osi_svc_user_table[OS_SVC_USER_MAX] = { NULL };
+
+const uint32_t osi_svc_user_table_size = OS_SVC_USER_MAX;
+
+#if defined(OS_CONFIG_SVC_STATS)
+
+uint32_t os_svc_stats_size() {
+    return OS_SVC_COUNT;
+}
+
+os_status_t os_svc_stats_get(uint32_t number, os_svc_stats_t *stats) {
+    if (number >= OS_SVC_COUNT) {
+        return OSS_ERROR_INVALID;
+    }
+
+    OS_LOCK();
+    memcpy(stats, &svc_stats[number], sizeof(os_svc_stats_t));
+    OS_UNLOCK();
+
+    stats->name = svc_names[number];
+
+    return OSS_SUCCESS;
+}
+
+os_status_t os_svc_stats_reset() {
+    OS_LOCK();
+    memset(svc_stats, 0, sizeof(svc_stats));
+    OS_UNLOCK();
+
+    return OSS_SUCCESS;
+}
+
+os_status_t os_svc_stats_dump() {
+    for (uint32_t i = 0; i < OS_SVC_COUNT; ++i) {
+        os_svc_stats_t stats;
+        os_svc_stats_get(i, &stats);
+        if (stats.calls == 0) {
+            continue;
+        }
+
+        osi_printf("%s: calls=%u cycles=%u avg=%u\n", stats.name, stats.calls, (uint32_t)stats.cycles, (uint32_t)(stats.cycles / stats.calls));
+        for (uint32_t b = 0; b < OS_SVC_STATS_BUCKETS; ++b) {
+            if (stats.buckets[b] > 0) {
+                osi_printf("  <%u: %u\n", (uint32_t)(1 << (b + 1)), stats.buckets[b]);
+            }
+        }
+    }
+
+    return OSS_SUCCESS;
+}
+
+#endif
+
+os_status_t os_svc_register(uint32_t number, os_svc_handler_t handler) {
+    if (number < OS_SVC_USER || number >= OS_SVC_USER + OS_SVC_USER_MAX) {
+        return OSS_ERROR_INVALID;
+    }
+
+    osi_svc_user_table[number - OS_SVC_USER] = handler;
+
+    return OSS_SUCCESS;
+}
+
 uint32_t svc_delay(uint32_t ms) {
     OS_ASSERT(osg.running != NULL);
     OS_ASSERT(osg.scheduled != osg.running);
@@ -44,8 +167,17 @@ uint32_t svc_delay(uint32_t ms) {
 }
 
 uint32_t svc_panic(uint32_t code) {
+#if defined(OS_CONFIG_SUPERVISOR)
+    // Supervised tasks get restarted instead of taking everything down.
+    if (osi_supervised((os_task_t *)osg.running)) {
+        osi_printf("%s: panic (%s)\n", osg.running->name, os_panic_kind_str((os_panic_kind_t)code));
+    } else {
+        osi_crash((os_panic_kind_t)code);
+    }
+#else
     // Invoke the hook. This may hup the MCU.
-    osi_panic((os_panic_kind_t)code);
+    osi_crash((os_panic_kind_t)code);
+#endif
 
     osi_task_status_set((os_task_t *)osg.running, OS_TASK_STATUS_PANIC);
 
@@ -72,6 +204,23 @@ uint32_t svc_abort(uint32_t code) {
     return OSS_SUCCESS;
 }
 
+uint32_t svc_finish(void) {
+    osi_task_status_set((os_task_t *)osg.running, OS_TASK_STATUS_FINISHED);
+
+    if (osg.scheduled == NULL) {
+        osi_schedule();
+    }
+
+    OS_ASSERT(osg.scheduled != NULL);
+    OS_ASSERT(osg.scheduled != osg.running);
+
+    return OSS_SUCCESS;
+}
+
+uint32_t svc_reschedule(void) {
+    return osi_reschedule();
+}
+
 uint32_t svc_block(uint32_t ms, uint32_t flags) {
     osg.running->flags |= flags;
     return svc_delay(ms);
@@ -142,6 +291,14 @@ os_status_t svc_rwlock_acquire_write(os_rwlock_t *rwlock, uint32_t to) {
     return osi_rwlock_acquire_write(rwlock, to);
 }
 
+os_status_t svc_rwlock_acquire_upgradeable(os_rwlock_t *rwlock, uint32_t to) {
+    return osi_rwlock_acquire_upgradeable(rwlock, to);
+}
+
+os_status_t svc_rwlock_upgrade(os_rwlock_t *rwlock, uint32_t to) {
+    return osi_rwlock_upgrade(rwlock, to);
+}
+
 os_status_t svc_rwlock_release(os_rwlock_t *rwlock) {
     return osi_rwlock_release(rwlock);
 }
@@ -192,7 +349,7 @@ uint32_t os_pstr(const char *str) {
 uint32_t os_panic(uint32_t code) {
     // If we're in a IRQ then this is pretty bad.
     if (__get_IPSR() != 0U) {
-        osi_panic(code);
+        osi_crash(code);
         return OSS_SUCCESS;
     }
     // In a task, we can call a SVC call and abandon the task.
@@ -201,7 +358,7 @@ uint32_t os_panic(uint32_t code) {
         return OSS_SUCCESS;
     }
     // We're in the master thread, likely before starting the OS.
-    osi_panic(code);
+    osi_crash(code);
     return OSS_SUCCESS;
 }
 
@@ -212,11 +369,51 @@ uint32_t os_abort(uint32_t code) {
     return __svc_abort(code);
 }
 
+os_status_t os_scheduler_lock() {
+    if (__get_IPSR() != 0U || osg.running == NULL) {
+        return OSS_ERROR_INVALID;
+    }
+
+    // Only the running task ever changes this, so no SVC is necessary.
+    os_task_t *self = os_task_self();
+    if (self->scheduler_locks == UINT16_MAX) {
+        return OSS_ERROR;
+    }
+    self->scheduler_locks++;
+
+    return OSS_SUCCESS;
+}
+
+os_status_t os_scheduler_unlock() {
+    if (__get_IPSR() != 0U || osg.running == NULL) {
+        return OSS_ERROR_INVALID;
+    }
+
+    os_task_t *self = os_task_self();
+    if (self->scheduler_locks == 0) {
+        return OSS_ERROR_INVALID;
+    }
+    if (--self->scheduler_locks > 0) {
+        return OSS_SUCCESS;
+    }
+
+    // Anything that happens after we're unlocked is handled normally, so we
+    // only need to trap if something was deferred before then.
+    if (osg.deferred != NULL || osg.reschedule) {
+        return __svc_reschedule();
+    }
+
+    return OSS_SUCCESS;
+}
+
 uint32_t os_printf(const char *f, ...) {
     uint32_t rval;
     va_list args;
     va_start(args, f);
-    if (osi_in_task()) {
+    // Tasks with their own ring don't need to trap.
+    if (__get_IPSR() == 0U && osg.running != NULL && osg.running->logger != NULL) {
+        rval = osi_logger_append((os_task_t *)osg.running, f, args);
+    } else if (osi_in_task()) {
         rval = __svc_printf(f, &args);
     } else {
         rval = svc_printf(f, &args);
@@ -244,6 +441,10 @@ os_tuple_t os_queue_enqueue(os_queue_t *queue, void *message, uint32_t to) {
 }
 
 os_tuple_t os_queue_dequeue(os_queue_t *queue, uint32_t to) {
+    if (__get_IPSR() != 0U) {
+        OS_ASSERT(to == 0);
+        return osi_queue_dequeue_isr(queue);
+    }
     return __svc_queue_dequeue(queue, to);
 }
 
@@ -258,6 +459,10 @@ os_status_t os_mutex_create(os_mutex_t *mutex, os_mutex_definition_t *def) {
 }
 
 os_status_t os_mutex_acquire(os_mutex_t *mutex, uint32_t to) {
+    // IRQs can't own a lock, see service.h.
+    if (__get_IPSR() != 0U) {
+        return OSS_ERROR_INVALID;
+    }
     os_status_t status = __svc_mutex_acquire(mutex, to);
     if (mutex->flags & OS_MUTEX_FLAG_ABORT_ON_TIMEOUT) {
         if (status == OSS_ERROR_TO) {
@@ -268,14 +473,35 @@ os_status_t os_mutex_acquire(os_mutex_t *mutex, uint32_t to) {
 }
 
 os_status_t os_mutex_release(os_mutex_t *mutex) {
+    // IRQs can't own a lock, see service.h.
+    if (__get_IPSR() != 0U) {
+        return OSS_ERROR_INVALID;
+    }
     return __svc_mutex_release(mutex);
 }
 
+os_status_t os_semaphore_create(os_semaphore_t *semaphore, os_semaphore_definition_t *def) {
+    if (__get_IPSR() != 0U) {
+        return OSS_ERROR_INVALID;
+    }
+    if (osi_in_task()) {
+        return __svc_semaphore_create(semaphore, def);
+    }
+    return svc_semaphore_create(semaphore, def);
+}
+
 os_status_t os_semaphore_acquire(os_semaphore_t *semaphore, uint32_t to) {
+    if (__get_IPSR() != 0U) {
+        OS_ASSERT(to == 0);
+        return osi_semaphore_acquire_isr(semaphore);
+    }
     return __svc_semaphore_acquire(semaphore, to);
 }
 
 os_status_t os_semaphore_release(os_semaphore_t *semaphore) {
+    if (__get_IPSR() != 0U) {
+        return osi_semaphore_release_isr(semaphore);
+    }
     return __svc_semaphore_release(semaphore);
 }
 
@@ -290,10 +516,18 @@ os_status_t os_rwlock_create(os_rwlock_t *rwlock, os_rwlock_definition_t *def) {
 }
 
 os_status_t os_rwlock_acquire_read(os_rwlock_t *rwlock, uint32_t to) {
+    // IRQs can't own a lock, see service.h.
+    if (__get_IPSR() != 0U) {
+        return OSS_ERROR_INVALID;
+    }
     return __svc_rwlock_acquire_read(rwlock, to);
 }
 
 os_status_t os_rwlock_acquire_write(os_rwlock_t *rwlock, uint32_t to) {
+    // IRQs can't own a lock, see service.h.
+    if (__get_IPSR() != 0U) {
+        return OSS_ERROR_INVALID;
+    }
     os_status_t rv = __svc_rwlock_acquire_write(rwlock, to);
     if (rv == OSS_SUCCESS) {
         OS_ASSERT(rwlock->readers == 0 && rwlock->writers == 1);
@@ -301,11 +535,39 @@ os_status_t os_rwlock_acquire_write(os_rwlock_t *rwlock, uint32_t to) {
     return rv;
 }
 
+os_status_t os_rwlock_acquire_upgradeable(os_rwlock_t *rwlock, uint32_t to) {
+    // IRQs can't own a lock, see service.h.
+    if (__get_IPSR() != 0U) {
+        return OSS_ERROR_INVALID;
+    }
+    return __svc_rwlock_acquire_upgradeable(rwlock, to);
+}
+
+os_status_t os_rwlock_upgrade(os_rwlock_t *rwlock, uint32_t to) {
+    // IRQs can't own a lock, see service.h.
+    if (__get_IPSR() != 0U) {
+        return OSS_ERROR_INVALID;
+    }
+    os_status_t rv = __svc_rwlock_upgrade(rwlock, to);
+    if (rv == OSS_SUCCESS) {
+        OS_ASSERT(rwlock->readers == 0 && rwlock->writers == 1);
+    }
+    return rv;
+}
+
 os_status_t os_rwlock_release(os_rwlock_t *rwlock) {
+    // IRQs can't own a lock, see service.h.
+    if (__get_IPSR() != 0U) {
+        return OSS_ERROR_INVALID;
+    }
     return __svc_rwlock_release(rwlock);
 }
 
 os_status_t os_signal(os_task_t *task, uint32_t signal) {
+    // Signals never block or wake anybody, so IRQs can just set them.
+    if (__get_IPSR() != 0U) {
+        return osi_signal(task, signal);
+    }
     return __svc_signal(task, signal);
 }
 
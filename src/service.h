@@ -18,6 +18,38 @@
 extern "C" {
 #endif
 
+/**
+ * Route `svc #number` to handler, number has to be in the range starting at
+ * OS_SVC_USER. Unregistered numbers return OSS_ERROR_INVALID to the caller.
+ */
+os_status_t os_svc_register(uint32_t number, os_svc_handler_t handler);
+
+#if defined(OS_CONFIG_SVC_STATS)
+
+/**
+ * Number of kernel SVCs, stats are indexed by SVC number and zero counts
+ * calls to invalid numbers.
+ */
+uint32_t os_svc_stats_size();
+
+/**
+ *
+ */
+os_status_t os_svc_stats_get(uint32_t number, os_svc_stats_t *stats);
+
+/**
+ *
+ */
+os_status_t os_svc_stats_reset();
+
+/**
+ * Print every SVC that's been called, using osi_printf so this goes out
+ * over RTT when OS_CONFIG_DEBUG_RTT is enabled.
+ */
+os_status_t os_svc_stats_dump();
+
+#endif
+
 /**
  *
  */
@@ -38,6 +70,18 @@ uint32_t os_panic(uint32_t code);
  */
 uint32_t os_abort(uint32_t code);
 
+/**
+ * Keep the running task from being preempted without masking any IRQs.
+ * These nest and any switch that was held off happens on the final unlock.
+ * Blocking while locked still lets other tasks run.
+ */
+os_status_t os_scheduler_lock();
+
+/**
+ *
+ */
+os_status_t os_scheduler_unlock();
+
 /**
  *
  */
@@ -64,12 +108,18 @@ os_tuple_t os_queue_enqueue(os_queue_t *queue, void *message, uint32_t to);
 os_tuple_t os_queue_dequeue(os_queue_t *queue, uint32_t to);
 
 /**
- *
+ * Mutexes and rwlocks belong to the task holding them, so unlike semaphores,
+ * queues and signals they have no IRQ path. Acquiring or releasing one from
+ * an IRQ returns OSS_ERROR_INVALID instead of trapping an SVC in handler
+ * mode.
  */
 os_status_t os_mutex_create(os_mutex_t *mutex, os_mutex_definition_t *def);
 
 /**
- *
+ * Returns OSS_ERROR_OWNER_DIED, still holding the mutex, when the previous
+ * owner panicked, aborted or finished without releasing it. Whatever the
+ * mutex protects may be half updated and should be repaired before
+ * releasing.
  */
 os_status_t os_mutex_acquire(os_mutex_t *mutex, uint32_t to);
 
@@ -90,13 +140,63 @@ os_status_t os_semaphore_acquire(os_semaphore_t *semaphore, uint32_t to);
 os_status_t os_semaphore_release(os_semaphore_t *semaphore);
 
 os_status_t os_rwlock_create(os_rwlock_t *rwlock, os_rwlock_definition_t *def);
+
+/**
+ * Reads nest, a task already reading rwlock gets in again even with writers
+ * waiting. A task can read up to OS_TASK_RWLOCK_READS_MAX rwlocks at once,
+ * past that this fails with OSS_ERROR_INVALID.
+ */
 os_status_t os_rwlock_acquire_read(os_rwlock_t *rwlock, uint32_t to);
 os_status_t os_rwlock_acquire_write(os_rwlock_t *rwlock, uint32_t to);
+
+/**
+ * Acquire a read that may later be upgraded to a write. Only one task may
+ * hold an upgradeable read, though it shares the lock with plain readers.
+ */
+os_status_t os_rwlock_acquire_upgradeable(os_rwlock_t *rwlock, uint32_t to);
+
+/**
+ * Atomically turn our upgradeable read into a write once the other readers
+ * have drained. On a timeout the upgradeable read is still held.
+ */
+os_status_t os_rwlock_upgrade(os_rwlock_t *rwlock, uint32_t to);
+
 os_status_t os_rwlock_release(os_rwlock_t *rwlock);
 
 os_status_t os_signal(os_task_t *task, uint32_t signal);
 os_status_t os_signal_check(uint32_t *signal);
 
+/**
+ * Walk every object of a kind that's been created, pass NULL to get the
+ * newest and NULL is returned after the oldest. Objects can't be
+ * destroyed, so iterating without a lock is safe.
+ */
+os_queue_t *os_queue_iterate(os_queue_t *iter);
+os_mutex_t *os_mutex_iterate(os_mutex_t *iter);
+os_semaphore_t *os_semaphore_iterate(os_semaphore_t *iter);
+os_rwlock_t *os_rwlock_iterate(os_rwlock_t *iter);
+
+/**
+ * Print every queue, mutex, semaphore and rwlock with its state, using
+ * osi_printf so this goes out over RTT when OS_CONFIG_DEBUG_RTT is enabled.
+ */
+os_status_t os_objects_dump();
+
+#if defined(OS_CONFIG_QUEUE_STATS)
+
+/**
+ * Copy a consistent snapshot of the queue's statistics.
+ */
+os_status_t os_queue_stats_get(os_queue_t *queue, os_queue_stats_t *stats);
+
+/**
+ * Clear the statistics, the high-water mark starts over at the current
+ * number of messages.
+ */
+os_status_t os_queue_stats_reset(os_queue_t *queue);
+
+#endif
+
 /**
  *
  */
@@ -107,7 +207,7 @@ os_status_t os_signal_check(uint32_t *signal);
  */
 #define os_queue_define(name, size, flags)                                                                                                 \
     os_queue_definition_t _os_queue_def_##name = { #name, size, flags };                                                                   \
-    uint32_t _os_queue_##name[os_word_size(os_queue_t) + (size)];
+    uint32_t _os_queue_##name[os_word_size(os_queue_t) + (size)*OS_QUEUE_SLOT_WORDS];
 
 /**
  *
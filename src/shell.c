@@ -0,0 +1,192 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "internal.h"
+
+static char shell_line[OS_SHELL_LINE_MAX + 1];
+static uint32_t shell_length = 0;
+static bool shell_overflowed = false;
+
+#if defined(ARDUINO)
+
+static uint32_t shell_read(char *buffer, uint32_t size) {
+    return SEGGER_RTT_Read(OS_SHELL_RTT_CHANNEL, buffer, size);
+}
+
+#else
+
+static char shell_input[128];
+static uint32_t shell_head = 0;
+static uint32_t shell_tail = 0;
+
+static uint32_t shell_read(char *buffer, uint32_t size) {
+    uint32_t read = 0;
+    for (; read < size && shell_tail != shell_head; ++read, ++shell_tail) {
+        buffer[read] = shell_input[shell_tail % sizeof(shell_input)];
+    }
+    return read;
+}
+
+uint32_t tests_shell_write(const char *buffer, uint32_t size) {
+    uint32_t written = 0;
+    for (; written < size && shell_head - shell_tail < sizeof(shell_input); ++written, ++shell_head) {
+        shell_input[shell_head % sizeof(shell_input)] = buffer[written];
+    }
+    return written;
+}
+
+#endif
+
+static const char *task_name(os_task_t *task) {
+    return task != NULL ? task->name : "-";
+}
+
+static bool word_is(const char *line, const char *word, const char **rest) {
+    while (*word != 0) {
+        if (*line++ != *word++) {
+            return false;
+        }
+    }
+    if (*line != 0 && *line != ' ') {
+        return false;
+    }
+    while (*line == ' ') {
+        line++;
+    }
+    *rest = line;
+    return true;
+}
+
+static void shell_tasks() {
+    uint32_t now = os_uptime();
+
+    osi_printf("%-12s %-9s %4s %5s %6s\n", "name", "status", "prio", "cpu%", "free");
+    for (os_task_t *iter = osg.tasks; iter != NULL; iter = iter->np) {
+        // Runtime is in microseconds and only counts finished turns, free
+        // stack is kept current by os_stack_scan.
+        uint64_t alive = (uint64_t)(now - iter->started) * 1000;
+        uint32_t permille = alive > 0 ? (uint32_t)(((uint64_t)iter->runtime * 1000) / alive) : 0;
+        const char *status = os_task_status_str(iter->status) + sizeof("OS_TASK_STATUS_") - 1;
+        osi_printf("%-12s %-9s %4d %3u.%u %6u\n", iter->name, status, iter->priority, permille / 10, permille % 10,
+                   (uint32_t)(iter->highwater * sizeof(uint32_t)));
+    }
+}
+
+static void shell_queues() {
+    osi_printf("%-12s %5s %5s\n", "name", "used", "size");
+    for (os_queue_t *iter = os_queue_iterate(NULL); iter != NULL; iter = os_queue_iterate(iter)) {
+        osi_printf("%-12s %5d %5d waiting(%s)\n", iter->def->name, iter->number, iter->size, task_name(iter->blocked.tasks));
+#if defined(OS_CONFIG_QUEUE_STATS)
+        osi_printf("  highwater=%d in=%u out=%u timeouts=%u\n", iter->stats.highwater, iter->stats.enqueued, iter->stats.dequeued,
+                   iter->stats.timeouts);
+#endif
+    }
+}
+
+static void shell_locks() {
+    for (os_mutex_t *iter = os_mutex_iterate(NULL); iter != NULL; iter = os_mutex_iterate(iter)) {
+        osi_printf("mutex %-12s owner(%s) waiting(%s)\n", iter->def->name, task_name(iter->owner), task_name(iter->blocked.tasks));
+    }
+    for (os_semaphore_t *iter = os_semaphore_iterate(NULL); iter != NULL; iter = os_semaphore_iterate(iter)) {
+        osi_printf("semaphore %-12s tokens(%u) waiting(%s)\n", iter->def->name, iter->tokens, task_name(iter->blocked.tasks));
+    }
+    for (os_rwlock_t *iter = os_rwlock_iterate(NULL); iter != NULL; iter = os_rwlock_iterate(iter)) {
+        osi_printf("rwlock %-12s readers(%d) writer(%s) waiting(%s)\n", iter->def->name, iter->readers, task_name(iter->writer),
+                   task_name(iter->blocked.tasks));
+    }
+}
+
+static os_status_t shell_trace(const char *args) {
+#if defined(OS_CONFIG_TRACE)
+    const char *rest = NULL;
+    if (word_is(args, "start", &rest)) {
+        return os_trace_start();
+    }
+    if (word_is(args, "stop", &rest)) {
+        return os_trace_stop();
+    }
+    return OSS_ERROR_INVALID;
+#else
+    osi_printf("tracing is disabled, see OS_CONFIG_TRACE\n");
+    return OSS_ERROR_INVALID;
+#endif
+}
+
+os_status_t os_shell_execute(const char *line) {
+    const char *args = NULL;
+
+    while (*line == ' ') {
+        line++;
+    }
+
+    if (*line == 0) {
+        return OSS_SUCCESS;
+    }
+    if (word_is(line, "tasks", &args)) {
+        shell_tasks();
+        return OSS_SUCCESS;
+    }
+    if (word_is(line, "queues", &args)) {
+        shell_queues();
+        return OSS_SUCCESS;
+    }
+    if (word_is(line, "locks", &args)) {
+        shell_locks();
+        return OSS_SUCCESS;
+    }
+    if (word_is(line, "trace", &args)) {
+        return shell_trace(args);
+    }
+    if (word_is(line, "help", &args)) {
+        osi_printf("commands: tasks, queues, locks, trace start|stop, help\n");
+        return OSS_SUCCESS;
+    }
+
+    osi_printf("unknown command: %s\n", line);
+    return OSS_ERROR_INVALID;
+}
+
+os_status_t os_shell_poll() {
+    char buffer[16];
+    uint32_t read;
+
+    while ((read = shell_read(buffer, sizeof(buffer))) > 0) {
+        for (uint32_t i = 0; i < read; ++i) {
+            char c = buffer[i];
+            if (c == '\r' || c == '\n') {
+                shell_line[shell_length] = 0;
+                if (shell_overflowed) {
+                    osi_printf("command too long\n");
+                } else {
+                    os_shell_execute(shell_line);
+                }
+                shell_length = 0;
+                shell_overflowed = false;
+            } else if (shell_length < OS_SHELL_LINE_MAX) {
+                shell_line[shell_length++] = c;
+            } else {
+                shell_overflowed = true;
+            }
+        }
+    }
+
+    return OSS_SUCCESS;
+}
+
+void os_shell_task(void *params) {
+    while (true) {
+        os_shell_poll();
+        os_delay(OS_SHELL_POLL_MS);
+    }
+}
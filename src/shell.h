@@ -0,0 +1,67 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_SHELL_H
+#define OS_SHELL_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * RTT down channel commands are read from, replies go wherever osi_printf
+ * does, so usually the matching up channel.
+ */
+#define OS_SHELL_RTT_CHANNEL (0)
+
+/**
+ * How often the shell task looks for input.
+ */
+#define OS_SHELL_POLL_MS (100)
+
+/**
+ * Longest command line, anything longer is dropped.
+ */
+#define OS_SHELL_LINE_MAX (32)
+
+/**
+ * Run one command line:
+ *
+ *   tasks           status, priority, CPU% and free stack of every task
+ *   queues          depth of every queue
+ *   locks           owners and waiters of every mutex, semaphore and rwlock
+ *   trace start     start the SystemView event stream (OS_CONFIG_TRACE)
+ *   trace stop
+ *   help
+ *
+ * Everything is read from live kernel state without locking, objects are
+ * never destroyed so the worst case is a slightly inconsistent line.
+ */
+os_status_t os_shell_execute(const char *line);
+
+/**
+ * Read whatever input is waiting and run any complete lines.
+ */
+os_status_t os_shell_poll();
+
+/**
+ * Task handler for the shell, give it a low priority and a stack of at
+ * least 512 bytes, osi_printf needs room.
+ */
+void os_shell_task(void *params);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
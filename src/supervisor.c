@@ -0,0 +1,158 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "internal.h"
+
+#if defined(OS_CONFIG_SUPERVISOR)
+
+static bool is_stopped(os_task_t *task) {
+    return task->status == OS_TASK_STATUS_FINISHED || task->status == OS_TASK_STATUS_PANIC || task->status == OS_TASK_STATUS_ABORTED;
+}
+
+static bool should_restart(os_supervisor_child_t *child) {
+    switch (child->restart) {
+    case OS_RESTART_PERMANENT:
+        return true;
+    case OS_RESTART_TRANSIENT:
+        return child->task->status != OS_TASK_STATUS_FINISHED;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Remembers the restart, returning false if that's one too many within the
+ * supervisor's period.
+ */
+static bool record_restart(os_supervisor_t *supervisor, uint32_t now) {
+    if (supervisor->nrestarts < supervisor->intensity) {
+        supervisor->restarted[supervisor->nrestarts++] = now;
+        return true;
+    }
+
+    // Full, so the oldest restart has to have aged out.
+    uint32_t oldest = supervisor->restarted[supervisor->restart];
+    if (now - oldest <= supervisor->period) {
+        return false;
+    }
+    supervisor->restarted[supervisor->restart] = now;
+    supervisor->restart = (supervisor->restart + 1) % supervisor->intensity;
+    return true;
+}
+
+os_status_t os_supervisor_create(os_supervisor_t *supervisor, const char *name, uint8_t intensity, uint32_t period) {
+    OS_ASSERT(supervisor != NULL);
+    OS_ASSERT(intensity > 0 && intensity <= OS_SUPERVISOR_INTENSITY_MAX);
+
+    supervisor->name = name;
+    supervisor->intensity = intensity;
+    supervisor->period = period;
+    supervisor->nrestarts = 0;
+    supervisor->restart = 0;
+    supervisor->failed = false;
+    supervisor->children = NULL;
+
+    OS_LOCK();
+
+    // Creating the same supervisor again mustn't link it twice.
+    bool found = false;
+    for (os_supervisor_t *iter = osg.supervisors; iter != NULL; iter = iter->next) {
+        if (iter == supervisor) {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        supervisor->next = osg.supervisors;
+        osg.supervisors = supervisor;
+    }
+
+    OS_UNLOCK();
+
+    return OSS_SUCCESS;
+}
+
+os_status_t os_supervisor_add(os_supervisor_t *supervisor, os_supervisor_child_t *child, os_task_t *task, os_restart_t restart) {
+    OS_ASSERT(supervisor != NULL);
+    OS_ASSERT(child != NULL);
+    OS_ASSERT(task != NULL);
+    OS_ASSERT(task != osg.idle);
+
+    child->task = task;
+    child->restart = restart;
+    child->priority = task->priority;
+    child->restarts = 0;
+
+    OS_LOCK();
+
+    child->next = supervisor->children;
+    supervisor->children = child;
+
+    OS_UNLOCK();
+
+    return OSS_SUCCESS;
+}
+
+bool osi_supervised(os_task_t *task) {
+    for (os_supervisor_t *iter = osg.supervisors; iter != NULL; iter = iter->next) {
+        if (iter->failed) {
+            continue;
+        }
+        for (os_supervisor_child_t *child = iter->children; child != NULL; child = child->next) {
+            if (child->task == task) {
+                return child->restart != OS_RESTART_TEMPORARY;
+            }
+        }
+    }
+    return false;
+}
+
+os_status_t osi_supervise() {
+    uint32_t now = os_uptime();
+
+    for (os_supervisor_t *iter = osg.supervisors; iter != NULL; iter = iter->next) {
+        if (iter->failed) {
+            continue;
+        }
+
+        for (os_supervisor_child_t *child = iter->children; child != NULL; child = child->next) {
+            os_task_t *task = child->task;
+
+            // Restarting the stack under PendSV would end badly.
+            if (!is_stopped(task) || task == osg.running || task == osg.scheduled) {
+                continue;
+            }
+            if (!should_restart(child)) {
+                continue;
+            }
+
+            if (!record_restart(iter, now)) {
+                osi_printf("supervisor '%s': too many restarts, giving up\n", iter->name);
+                iter->failed = true;
+                osi_crash(OS_PANIC_SUPERVISOR);
+                return OSS_ERROR;
+            }
+
+            osi_printf("supervisor '%s': restarting '%s' (%s)\n", iter->name, task->name, os_task_status_str(task->status));
+
+            os_task_start_options(task, child->priority, task->params);
+            child->restarts++;
+        }
+    }
+
+    return OSS_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_SUPERVISOR_H
+#define OS_SUPERVISOR_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#if defined(OS_CONFIG_SUPERVISOR)
+
+/**
+ * Allow intensity restarts within period ms across all the supervisor's
+ * children. Beyond that something's more wrong than a restart will fix,
+ * so the supervisor panics with OS_PANIC_SUPERVISOR, which by default
+ * resets. Intensity has to be at least 1.
+ */
+os_status_t os_supervisor_create(os_supervisor_t *supervisor, const char *name, uint8_t intensity, uint32_t period);
+
+/**
+ * Supervise task, restarting it with os_task_start_options and the
+ * priority and params it has now when it stops. A task panicking under a
+ * supervisor no longer resets the MCU.
+ */
+os_status_t os_supervisor_add(os_supervisor_t *supervisor, os_supervisor_child_t *child, os_task_t *task, os_restart_t restart);
+
+/**
+ * Whether task has a supervisor that'll restart it.
+ */
+bool osi_supervised(os_task_t *task);
+
+/**
+ * Restart children that have stopped, called from SysTick. Children are
+ * left alone until they've been switched out. The restart itself runs in
+ * the ISR, including repainting the part of the child's stack it used, so
+ * children with deep stacks make for a longer SysTick.
+ */
+os_status_t osi_supervise();
+
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -32,22 +32,13 @@
 
 #define SVC_Arg4(t1, t2, t3, t4) SVC_ArgR(0, t1, a1) SVC_ArgR(1, t2, a2) SVC_ArgR(2, t3, a3) SVC_ArgR(3, t4, a4)
 
-#if defined(__SAMD21__)
+/* The SVC number is looked up by SVC_Handler, everything but r0 - r3 is
+   restored from the exception frame on the way out. */
 #define SVC_Call(f)                                                                                                                        \
-    __asm volatile("ldr r7,=" #f "\n\t"                                                                                                    \
-                   "mov r12,r7\n\t"                                                                                                        \
-                   "svc 0"                                                                                                                 \
+    __asm volatile("svc %[n]"                                                                                                              \
                    : "=r"(__r0), "=r"(__r1), "=r"(__r2), "=r"(__r3)                                                                        \
-                   : "r"(__r0), "r"(__r1), "r"(__r2), "r"(__r3)                                                                            \
-                   : "r7", "r12", "lr", "cc");
-#else
-#define SVC_Call(f)                                                                                                                        \
-    __asm volatile("ldr r12,=" #f "\n\t"                                                                                                   \
-                   "svc 0"                                                                                                                 \
-                   : "=r"(__r0), "=r"(__r1), "=r"(__r2), "=r"(__r3)                                                                        \
-                   : "r"(__r0), "r"(__r1), "r"(__r2), "r"(__r3)                                                                            \
-                   : "r12", "lr", "cc");
-#endif
+                   : [n] "n"(OS_SVC_##f), "r"(__r0), "r"(__r1), "r"(__r2), "r"(__r3)                                                       \
+                   : "memory", "cc");
 
 #define SVC_0_1(f, t, rv)                                                                                                                  \
     __attribute__((always_inline)) static inline t __##f(void) {                                                                           \
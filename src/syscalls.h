@@ -18,12 +18,59 @@
 
 #include "syscall_plumbing.h"
 
+/**
+ * Every kernel SVC, in SVC number order starting at 1. Zero is never valid.
+ */
+#define OS_SVC_TABLE(X)                                                                                                                    \
+    X(svc_delay)                                                                                                                           \
+    X(svc_block)                                                                                                                           \
+    X(svc_printf)                                                                                                                          \
+    X(svc_pstr)                                                                                                                            \
+    X(svc_panic)                                                                                                                           \
+    X(svc_abort)                                                                                                                           \
+    X(svc_reschedule)                                                                                                                      \
+    X(svc_queue_create)                                                                                                                    \
+    X(svc_queue_enqueue)                                                                                                                   \
+    X(svc_queue_dequeue)                                                                                                                   \
+    X(svc_mutex_create)                                                                                                                    \
+    X(svc_mutex_acquire)                                                                                                                   \
+    X(svc_mutex_release)                                                                                                                   \
+    X(svc_semaphore_create)                                                                                                                \
+    X(svc_semaphore_acquire)                                                                                                               \
+    X(svc_semaphore_release)                                                                                                               \
+    X(svc_rwlock_create)                                                                                                                   \
+    X(svc_rwlock_acquire_read)                                                                                                             \
+    X(svc_rwlock_acquire_write)                                                                                                            \
+    X(svc_rwlock_acquire_upgradeable)                                                                                                      \
+    X(svc_rwlock_upgrade)                                                                                                                  \
+    X(svc_rwlock_release)                                                                                                                  \
+    X(svc_signal)                                                                                                                          \
+    X(svc_signal_check)                                                                                                                    \
+    X(svc_finish)
+
+#define OS_SVC_NUMBER(f) OS_SVC_##f,
+
+enum {
+    OS_SVC_NONE = 0,
+    OS_SVC_TABLE(OS_SVC_NUMBER) OS_SVC_COUNT,
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 uint32_t svc_delay(uint32_t ms);
 uint32_t svc_block(uint32_t ms, uint32_t flags);
 uint32_t svc_printf(const char *str, void *vargs);
 uint32_t svc_pstr(const char *str);
 uint32_t svc_panic(uint32_t code);
 uint32_t svc_abort(uint32_t code);
+uint32_t svc_finish(void);
+uint32_t svc_reschedule(void);
+
+#if defined(__cplusplus)
+}
+#endif
 
 SVC_1_1(svc_delay, uint32_t, uint32_t, RET_uint32_t);
 SVC_2_1(svc_block, uint32_t, uint32_t, uint32_t, RET_uint32_t);
@@ -31,6 +78,8 @@ SVC_2_1(svc_printf, uint32_t, const char *, void *, RET_uint32_t);
 SVC_1_1(svc_pstr, uint32_t, const char *, RET_uint32_t);
 SVC_1_1(svc_panic, uint32_t, uint32_t, RET_uint32_t);
 SVC_1_1(svc_abort, uint32_t, uint32_t, RET_uint32_t);
+SVC_0_1(svc_finish, uint32_t, RET_uint32_t);
+SVC_0_1(svc_reschedule, uint32_t, RET_uint32_t);
 
 os_status_t svc_queue_create(os_queue_t *queue, os_queue_definition_t *def);
 os_tuple_return_type_t svc_queue_enqueue(os_queue_t *queue, void *message, uint32_t to);
@@ -59,11 +108,15 @@ SVC_1_1(svc_semaphore_release, os_status_t, os_semaphore_t *, RET_os_status_t);
 os_status_t svc_rwlock_create(os_rwlock_t *rwlock, os_rwlock_definition_t *def);
 os_status_t svc_rwlock_acquire_read(os_rwlock_t *rwlock, uint32_t to);
 os_status_t svc_rwlock_acquire_write(os_rwlock_t *rwlock, uint32_t to);
+os_status_t svc_rwlock_acquire_upgradeable(os_rwlock_t *rwlock, uint32_t to);
+os_status_t svc_rwlock_upgrade(os_rwlock_t *rwlock, uint32_t to);
 os_status_t svc_rwlock_release(os_rwlock_t *rwlock);
 
 SVC_2_1(svc_rwlock_create, os_status_t, os_rwlock_t *, os_rwlock_definition_t *, RET_os_status_t);
 SVC_2_1(svc_rwlock_acquire_read, os_status_t, os_rwlock_t *, uint32_t, RET_os_status_t);
 SVC_2_1(svc_rwlock_acquire_write, os_status_t, os_rwlock_t *, uint32_t, RET_os_status_t);
+SVC_2_1(svc_rwlock_acquire_upgradeable, os_status_t, os_rwlock_t *, uint32_t, RET_os_status_t);
+SVC_2_1(svc_rwlock_upgrade, os_status_t, os_rwlock_t *, uint32_t, RET_os_status_t);
 SVC_1_1(svc_rwlock_release, os_status_t, os_rwlock_t *, RET_os_status_t);
 
 os_status_t svc_signal(os_task_t *task, uint32_t signal);
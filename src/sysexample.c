@@ -15,6 +15,8 @@
 #include "sysexample.h"
 #include "syscall_plumbing.h"
 
+#define OS_SVC_svc_example (OS_SVC_USER + 0)
+
 uint32_t svc_example(void) {
     osi_printf("svc_example\n");
     return 0;
@@ -22,6 +24,10 @@ uint32_t svc_example(void) {
 
 SVC_0_1(svc_example, uint32_t, RET_uint32_t);
 
+os_status_t os_example_initialize() {
+    return os_svc_register(OS_SVC_svc_example, (os_svc_handler_t)&svc_example);
+}
+
 uint32_t os_example() {
     if (osi_in_task()) {
         return __svc_example();
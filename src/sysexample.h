@@ -18,6 +18,11 @@
 extern "C" {
 #endif
 
+/**
+ * Registers the example SVC, call before using os_example.
+ */
+os_status_t os_example_initialize();
+
 /**
  *
  */
@@ -0,0 +1,315 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "internal.h"
+
+#if defined(OS_CONFIG_TRACE)
+
+/**
+ * Task ids are shrunk by SystemView as (address - base) >> shift, so tell
+ * it where RAM starts.
+ */
+#if defined(__SAMD21__) || defined(__SAMD51__)
+#define TRACE_RAM_BASE      (0x20000000)
+#define TRACE_ID_SHIFT      (2)
+#define TRACE_CPU_FREQUENCY (SystemCoreClock)
+#else
+#define TRACE_RAM_BASE      (0)
+#define TRACE_ID_SHIFT      (0)
+#define TRACE_CPU_FREQUENCY (0)
+#endif
+
+#define TRACE_NAME_MAX   (32)
+#define TRACE_PACKET_MAX (64)
+
+static bool trace_enabled = false;
+static uint32_t trace_last = 0;
+static uint32_t trace_dropped = 0;
+static uint32_t trace_reported = 0;
+static os_trace_recent_t trace_recent[OS_TRACE_RECENT_SIZE];
+static uint32_t trace_recent_head = 0;
+
+#if defined(ARDUINO)
+
+static uint8_t trace_buffer[OS_TRACE_BUFFER_SIZE];
+
+static os_status_t trace_configure() {
+    if (SEGGER_RTT_ConfigUpBuffer(OS_TRACE_RTT_CHANNEL, "SysView", trace_buffer, sizeof(trace_buffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP) <
+        0) {
+        return OSS_ERROR_INVALID;
+    }
+    return OSS_SUCCESS;
+}
+
+static bool trace_append(const uint8_t *packet, uint32_t size) {
+    return SEGGER_RTT_Write(OS_TRACE_RTT_CHANNEL, packet, size) == size;
+}
+
+#else
+
+static uint8_t trace_buffer[OS_TRACE_BUFFER_SIZE];
+static uint32_t trace_head = 0;
+static uint32_t trace_tail = 0;
+
+static os_status_t trace_configure() {
+    trace_head = 0;
+    trace_tail = 0;
+    return OSS_SUCCESS;
+}
+
+static bool trace_append(const uint8_t *packet, uint32_t size) {
+    if (sizeof(trace_buffer) - (trace_head - trace_tail) < size) {
+        return false;
+    }
+    for (uint32_t i = 0; i < size; ++i) {
+        trace_buffer[(trace_head + i) % sizeof(trace_buffer)] = packet[i];
+    }
+    trace_head += size;
+    return true;
+}
+
+uint32_t tests_trace_read(void *buffer, uint32_t size) {
+    uint32_t read = 0;
+    for (; read < size && trace_tail != trace_head; ++read, ++trace_tail) {
+        ((uint8_t *)buffer)[read] = trace_buffer[trace_tail % sizeof(trace_buffer)];
+    }
+    return read;
+}
+
+#endif
+
+typedef struct trace_packet_t {
+    uint8_t data[TRACE_PACKET_MAX];
+    uint32_t size;
+} trace_packet_t;
+
+static void packet_u32(trace_packet_t *packet, uint32_t value) {
+    while (value > 0x7f) {
+        packet->data[packet->size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    packet->data[packet->size++] = (uint8_t)value;
+}
+
+static void packet_str(trace_packet_t *packet, const char *str) {
+    uint32_t length = 0;
+    while (str != NULL && str[length] != 0 && length < TRACE_NAME_MAX) {
+        length++;
+    }
+    packet->data[packet->size++] = (uint8_t)length;
+    memcpy(&packet->data[packet->size], str, length);
+    packet->size += length;
+}
+
+static uint32_t task_id(os_task_t *task) {
+    return ((uint32_t)(uintptr_t)task - TRACE_RAM_BASE) >> TRACE_ID_SHIFT;
+}
+
+/**
+ * Events under 24 are the id then the payload, the rest also carry the
+ * payload length. Every packet ends with the time since the last one.
+ */
+static void trace_send(uint32_t event, const uint8_t *payload, uint32_t size) {
+    if (!trace_enabled) {
+        return;
+    }
+
+    trace_packet_t packet = { { 0 }, 0 };
+
+    OS_LOCK();
+
+    packet_u32(&packet, event);
+    if (event >= 24) {
+        packet_u32(&packet, size);
+    }
+    memcpy(&packet.data[packet.size], payload, size);
+    packet.size += size;
+
+    uint32_t now = os_micros();
+    packet_u32(&packet, now - trace_last);
+
+    if (trace_dropped != trace_reported) {
+        trace_packet_t overflow = { { OS_TRACE_EVENT_OVERFLOW }, 1 };
+        packet_u32(&overflow, trace_dropped - trace_reported);
+        packet_u32(&overflow, now - trace_last);
+        if (trace_append(overflow.data, overflow.size)) {
+            trace_reported = trace_dropped;
+        }
+    }
+
+    if (trace_append(packet.data, packet.size)) {
+        trace_last = now;
+    } else {
+        trace_dropped++;
+    }
+
+    OS_UNLOCK();
+}
+
+static void trace_remember(uint32_t event, uint32_t value) {
+    OS_LOCK();
+    os_trace_recent_t *recent = &trace_recent[trace_recent_head++ % OS_TRACE_RECENT_SIZE];
+    recent->time = os_micros();
+    recent->event = event;
+    recent->value = value;
+    OS_UNLOCK();
+}
+
+static void trace_send_void(uint32_t event) {
+    trace_remember(event, 0);
+    trace_send(event, NULL, 0);
+}
+
+static void trace_send_u32(uint32_t event, uint32_t value) {
+    trace_remember(event, value);
+    trace_packet_t payload = { { 0 }, 0 };
+    packet_u32(&payload, value);
+    trace_send(event, payload.data, payload.size);
+}
+
+static void trace_send_task_info(os_task_t *task) {
+    trace_packet_t payload = { { 0 }, 0 };
+    packet_u32(&payload, task_id(task));
+    packet_u32(&payload, task->priority);
+    packet_str(&payload, task->name);
+    trace_send(OS_TRACE_EVENT_TASK_INFO, payload.data, payload.size);
+}
+
+os_status_t os_trace_start() {
+    static const uint8_t sync[10] = { 0 };
+
+    os_status_t err = trace_configure();
+    if (err != OSS_SUCCESS) {
+        return err;
+    }
+
+    trace_last = os_micros();
+    trace_dropped = 0;
+    trace_reported = 0;
+    trace_enabled = true;
+
+    trace_append(sync, sizeof(sync));
+    trace_send_void(OS_TRACE_EVENT_TRACE_START);
+
+    trace_packet_t init = { { 0 }, 0 };
+    packet_u32(&init, 1000000);
+    packet_u32(&init, TRACE_CPU_FREQUENCY);
+    packet_u32(&init, TRACE_RAM_BASE);
+    packet_u32(&init, TRACE_ID_SHIFT);
+    trace_send(OS_TRACE_EVENT_INIT, init.data, init.size);
+
+    trace_packet_t description = { { 0 }, 0 };
+    packet_str(&description, "N=arduino-osh,O=osh");
+    trace_send(OS_TRACE_EVENT_SYSDESC, description.data, description.size);
+
+    // Microseconds since boot as 64 bits, low word first.
+    trace_packet_t systime = { { 0 }, 0 };
+    packet_u32(&systime, os_micros());
+    packet_u32(&systime, 0);
+    trace_send(OS_TRACE_EVENT_SYSTIME_US, systime.data, systime.size);
+
+    for (os_task_t *iter = osg.tasks; iter != NULL; iter = iter->np) {
+        trace_send_task_info(iter);
+    }
+
+    return OSS_SUCCESS;
+}
+
+os_status_t os_trace_stop() {
+    trace_send_void(OS_TRACE_EVENT_TRACE_STOP);
+    trace_enabled = false;
+    return OSS_SUCCESS;
+}
+
+void os_trace_isr_enter() {
+    trace_send_u32(OS_TRACE_EVENT_ISR_ENTER, __get_IPSR() & 0x1ff);
+}
+
+void os_trace_isr_exit() {
+    if (osg.scheduled != NULL) {
+        trace_send_void(OS_TRACE_EVENT_ISR_TO_SCHEDULER);
+    } else {
+        trace_send_void(OS_TRACE_EVENT_ISR_EXIT);
+    }
+}
+
+void os_trace_timer_enter(uint32_t id) {
+    trace_send_u32(OS_TRACE_EVENT_TIMER_ENTER, id);
+}
+
+void os_trace_timer_exit() {
+    trace_send_void(OS_TRACE_EVENT_TIMER_EXIT);
+}
+
+uint32_t os_trace_dropped() {
+    return trace_dropped;
+}
+
+uint32_t osi_trace_recent(os_trace_recent_t *events, uint32_t size) {
+    uint32_t available = trace_recent_head < OS_TRACE_RECENT_SIZE ? trace_recent_head : OS_TRACE_RECENT_SIZE;
+    uint32_t n = available < size ? available : size;
+    for (uint32_t i = 0; i < n; ++i) {
+        events[i] = trace_recent[(trace_recent_head - n + i) % OS_TRACE_RECENT_SIZE];
+    }
+    return n;
+}
+
+void osi_trace_task_create(os_task_t *task) {
+    trace_send_u32(OS_TRACE_EVENT_TASK_CREATE, task_id(task));
+    trace_send_task_info(task);
+}
+
+void osi_trace_task_status(os_task_t *task, os_task_status old_status) {
+    os_task_status new_status = task->status;
+    if (old_status == new_status) {
+        return;
+    }
+
+    switch (new_status) {
+    case OS_TASK_STATUS_IDLE:
+    case OS_TASK_STATUS_ACTIVE:
+        // Dispatch goes straight from waiting to active.
+        if (old_status != OS_TASK_STATUS_ACTIVE && old_status != OS_TASK_STATUS_IDLE) {
+            trace_send_u32(OS_TRACE_EVENT_TASK_START_READY, task_id(task));
+        }
+        break;
+    case OS_TASK_STATUS_WAIT:
+    case OS_TASK_STATUS_SUSPENDED: {
+        // The cause shows up as the blocking object kind.
+        trace_packet_t payload = { { 0 }, 0 };
+        trace_remember(OS_TRACE_EVENT_TASK_STOP_READY, task_id(task));
+        packet_u32(&payload, task_id(task));
+        packet_u32(&payload, new_status == OS_TASK_STATUS_WAIT ? task->flags : 0);
+        trace_send(OS_TRACE_EVENT_TASK_STOP_READY, payload.data, payload.size);
+        break;
+    }
+    case OS_TASK_STATUS_FINISHED:
+    case OS_TASK_STATUS_PANIC:
+    case OS_TASK_STATUS_ABORTED:
+        trace_send_u32(OS_TRACE_EVENT_TASK_TERMINATE, task_id(task));
+        break;
+    default:
+        break;
+    }
+}
+
+void osi_trace_task_switch(os_task_t *task) {
+    if (task == osg.idle) {
+        trace_send_void(OS_TRACE_EVENT_IDLE);
+    } else {
+        trace_send_u32(OS_TRACE_EVENT_TASK_START_EXEC, task_id(task));
+    }
+}
+
+#endif
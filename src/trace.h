@@ -0,0 +1,139 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_TRACE_H
+#define OS_TRACE_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * RTT up channel the event stream is written to.
+ */
+#define OS_TRACE_RTT_CHANNEL (2)
+
+/**
+ * Size of the RTT buffer for the event stream.
+ */
+#define OS_TRACE_BUFFER_SIZE (2048)
+
+/**
+ * Number of the most recent events kept in RAM for crash snapshots, these
+ * are kept even when nobody's recording.
+ */
+#define OS_TRACE_RECENT_SIZE (16)
+
+/**
+ * Event ids, these match SEGGER SystemView so recordings open there.
+ */
+#define OS_TRACE_EVENT_NOP              (0)
+#define OS_TRACE_EVENT_OVERFLOW         (1)
+#define OS_TRACE_EVENT_ISR_ENTER        (2)
+#define OS_TRACE_EVENT_ISR_EXIT         (3)
+#define OS_TRACE_EVENT_TASK_START_EXEC  (4)
+#define OS_TRACE_EVENT_TASK_STOP_EXEC   (5)
+#define OS_TRACE_EVENT_TASK_START_READY (6)
+#define OS_TRACE_EVENT_TASK_STOP_READY  (7)
+#define OS_TRACE_EVENT_TASK_CREATE      (8)
+#define OS_TRACE_EVENT_TASK_INFO        (9)
+#define OS_TRACE_EVENT_TRACE_START      (10)
+#define OS_TRACE_EVENT_TRACE_STOP       (11)
+#define OS_TRACE_EVENT_SYSTIME_US       (13)
+#define OS_TRACE_EVENT_SYSDESC          (14)
+#define OS_TRACE_EVENT_IDLE             (17)
+#define OS_TRACE_EVENT_ISR_TO_SCHEDULER (18)
+#define OS_TRACE_EVENT_TIMER_ENTER      (19)
+#define OS_TRACE_EVENT_TIMER_EXIT       (20)
+#define OS_TRACE_EVENT_INIT             (24)
+#define OS_TRACE_EVENT_TASK_TERMINATE   (29)
+
+/**
+ * The value is usually the task id, see the SystemView event docs.
+ */
+typedef struct os_trace_recent_t {
+    uint32_t time;
+    uint32_t event;
+    uint32_t value;
+} os_trace_recent_t;
+
+#if defined(OS_CONFIG_TRACE)
+
+/**
+ * Start recording, this sends the sync pattern, system description and the
+ * current task list before any events.
+ */
+os_status_t os_trace_start();
+
+/**
+ *
+ */
+os_status_t os_trace_stop();
+
+/**
+ * Call first and last thing in application IRQ handlers. Of the kernel's
+ * own handlers only SysTick is recorded this way, SVC and PendSV are written
+ * in assembly and only show up as the task switches they cause.
+ */
+void os_trace_isr_enter();
+
+/**
+ *
+ */
+void os_trace_isr_exit();
+
+/**
+ * Call around application timer callbacks.
+ */
+void os_trace_timer_enter(uint32_t id);
+
+/**
+ *
+ */
+void os_trace_timer_exit();
+
+/**
+ * Number of events that didn't fit in the buffer.
+ */
+uint32_t os_trace_dropped();
+
+/**
+ * Copy the most recent events, oldest first, returns how many.
+ */
+uint32_t osi_trace_recent(os_trace_recent_t *events, uint32_t size);
+
+void osi_trace_task_create(os_task_t *task);
+void osi_trace_task_status(os_task_t *task, os_task_status old_status);
+void osi_trace_task_switch(os_task_t *task);
+
+#define OS_TRACE_TASK_CREATE(task)             osi_trace_task_create(task)
+#define OS_TRACE_TASK_STATUS(task, old_status) osi_trace_task_status(task, old_status)
+#define OS_TRACE_TASK_SWITCH(task)             osi_trace_task_switch(task)
+#define OS_TRACE_ISR_ENTER()                   os_trace_isr_enter()
+#define OS_TRACE_ISR_EXIT()                    os_trace_isr_exit()
+
+#else
+
+#define OS_TRACE_TASK_CREATE(task)
+#define OS_TRACE_TASK_STATUS(task, old_status)
+#define OS_TRACE_TASK_SWITCH(task)
+#define OS_TRACE_ISR_ENTER()
+#define OS_TRACE_ISR_EXIT()
+
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
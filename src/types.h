@@ -40,9 +40,93 @@ extern "C" {
  */
 #define OS_CONFIG_PARANOIA
 
+/**
+ * Count calls and measure cycles spent in each SVC, see os_svc_stats_get.
+ */
+/*
+#define OS_CONFIG_SVC_STATS
+*/
+
+/**
+ * Stream scheduler events over RTT in SEGGER SystemView's format, see
+ * os_trace_start.
+ */
+/*
+#define OS_CONFIG_TRACE
+*/
+
+/**
+ * Count acquisitions, contention, timeouts, wait and hold times for every
+ * mutex, semaphore and rwlock, see os_lock_stats_iterate.
+ */
+/*
+#define OS_CONFIG_LOCK_STATS
+*/
+
+/**
+ * Track occupancy, throughput and latency of every queue, this timestamps
+ * each slot so queues take a word more per message, see os_queue_stats_get.
+ */
+/*
+#define OS_CONFIG_QUEUE_STATS
+*/
+
+/**
+ * Keep a snapshot of tasks, fault registers, held locks and recent trace
+ * events in RAM that survives the reset after a panic or hard fault, see
+ * os_crash_snapshot. Recent events are only recorded when OS_CONFIG_TRACE is
+ * also defined.
+ */
+/*
+#define OS_CONFIG_CRASH_SNAPSHOT
+*/
+
+/**
+ * Use the M4's MPU to make the bottom of the running task's stack
+ * inaccessible, so an overflow faults immediately instead of being noticed
+ * on the next switch. Replaces the magic word check and costs each stack up
+ * to 2 * OS_STACK_GUARD_SIZE bytes. Ignored where there's no MPU.
+ */
+/*
+#define OS_CONFIG_MPU_STACK_GUARD
+*/
+
+/**
+ * Tasks register with a period and check in, SysTick feeds the hardware
+ * watchdog only while every one of them is on time, see os_watchdog_start.
+ */
+/*
+#define OS_CONFIG_WATCHDOG
+*/
+
+/**
+ * Restart tasks that panic, abort or finish instead of resetting, see
+ * os_supervisor_create.
+ */
+/*
+#define OS_CONFIG_SUPERVISOR
+*/
+
+#if defined(OS_CONFIG_MPU_STACK_GUARD) && !defined(__SAMD51__)
+#undef OS_CONFIG_MPU_STACK_GUARD
+#endif
+
 #define OS_IRQ_PRIORITY_PENDSV  (0x7)
 #define OS_IRQ_PRIORITY_SYSTICK (0x2)
 
+/**
+ * SVC numbers from OS_SVC_USER up belong to the application, see
+ * os_svc_register. Keep in sync with gcc.s
+ */
+#define OS_SVC_USER     (128)
+#define OS_SVC_USER_MAX (8)
+
+/**
+ * Number of rwlocks a task can hold reads on at once, reads beyond that
+ * fail with OSS_ERROR_INVALID rather than going untracked.
+ */
+#define OS_TASK_RWLOCK_READS_MAX (2)
+
 /**
  *
  */
@@ -62,6 +146,17 @@ extern "C" {
 #define OS_STACK_MINIMUM_SIZE_WORDS  (OS_STACK_EXTENDED_FRAME_SIZE + 8)
 #define OS_STACK_MINIMUM_SIZE        (OS_STACK_MINIMUM_SIZE_WORDS * 4)
 
+/**
+ * Smallest MPU region, the guard is the first one of these that's entirely
+ * inside the stack.
+ */
+#define OS_STACK_GUARD_SIZE (32)
+
+/**
+ * Highest numbered MPU region wins where regions overlap.
+ */
+#define OS_STACK_GUARD_MPU_REGION (7)
+
 /**
  *
  */
@@ -112,18 +207,45 @@ static inline bool os_task_status_is_alive(os_task_status status) {
 }
 
 #define OS_TASK_FLAG_NONE      (0)
-#define OS_TASK_FLAG_MUTEX     (1)
-#define OS_TASK_FLAG_QUEUE     (2)
-#define OS_TASK_FLAG_SEMAPHORE (3)
-#define OS_TASK_FLAG_RWLOCK    (4)
+#define OS_TASK_FLAG_MUTEX     (1 << 0)
+#define OS_TASK_FLAG_QUEUE     (1 << 1)
+#define OS_TASK_FLAG_SEMAPHORE (1 << 2)
+#define OS_TASK_FLAG_RWLOCK    (1 << 3)
 
 struct os_queue_t;
 struct os_mutex_t;
 struct os_semaphore_t;
 struct os_rwlock_t;
+struct os_logger_ring_t;
+
+/**
+ * A read a task holds, depth counts nested reads of the same rwlock.
+ */
+typedef struct os_rwlock_read_t {
+    struct os_rwlock_t *rwlock;
+    uint16_t depth;
+} os_rwlock_read_t;
 
 typedef uint32_t os_priority_t;
 
+/**
+ * Handlers are called with the caller's r0 - r3 and their r0 - r2 returned.
+ */
+typedef void (*os_svc_handler_t)(void);
+
+#define OS_SVC_STATS_BUCKETS (16)
+
+/**
+ * Bucket i counts calls that took [2^i, 2^(i+1)) cycles, the last bucket
+ * gets everything slower than that.
+ */
+typedef struct os_svc_stats_t {
+    const char *name;
+    uint32_t calls;
+    uint64_t cycles;
+    uint32_t buckets[OS_SVC_STATS_BUCKETS];
+} os_svc_stats_t;
+
 /**
  *
  */
@@ -140,6 +262,7 @@ typedef struct os_task_options_t {
     uint32_t *stack;
     size_t stack_size;
     os_priority_t priority;
+    os_priority_t preemption_threshold; /* Zero means the priority itself. */
 } os_task_options_t;
 
 /**
@@ -165,7 +288,10 @@ typedef struct os_task_t {
     struct os_mutex_t *mutex;
     struct os_semaphore_t *semaphore;
     struct os_rwlock_t *rwlock;
+    os_rwlock_read_t rwlock_reads[OS_TASK_RWLOCK_READS_MAX];
+    uint16_t scheduler_locks;
     os_priority_t priority;
+    os_priority_t preemption_threshold;
     union {
         void *message;
         uint32_t desired;
@@ -177,11 +303,16 @@ typedef struct os_task_t {
     uint32_t delay;
     uint32_t flags;
     uint32_t signal;
-    uint32_t highwater;
+    uint32_t highwater;      //! Words at the bottom of the stack that have never been used. */
+    uint32_t highwater_scan; //! Where os_stack_scan will look next. */
+    struct os_logger_ring_t *logger;
     void *user_data;
 #if defined(OS_CONFIG_DEBUG)
     uint32_t debug_stack_max;
 #endif
+#if defined(OS_CONFIG_LOCK_STATS)
+    uint32_t blocked_since;
+#endif
 } os_task_t;
 
 /**
@@ -216,6 +347,23 @@ typedef struct os_queue_definition_t {
     uint16_t flags;
 } os_queue_definition_t;
 
+/**
+ * Latency is from enqueue to dequeue in microseconds, messages handed
+ * straight to a waiting receiver count as zero. Blocks count tasks that
+ * had to wait because the queue was full or empty, timeouts are the ones
+ * that gave up.
+ */
+typedef struct os_queue_stats_t {
+    uint32_t enqueued;
+    uint32_t dequeued;
+    uint16_t highwater;
+    uint32_t full_blocks;
+    uint32_t empty_blocks;
+    uint32_t timeouts;
+    uint64_t latency_total;
+    uint32_t latency_max;
+} os_queue_stats_t;
+
 /**
  *
  */
@@ -227,11 +375,51 @@ typedef struct os_queue_t {
     uint16_t first;
     uint16_t last;
     os_queue_status_t status;
+    struct os_queue_t *next; //! Next in osg.queues. */
+#if defined(OS_CONFIG_QUEUE_STATS)
+    os_queue_stats_t stats;
+#endif
     void *messages[1];
 } os_queue_t;
 
+/**
+ * Words of storage per message. Pointers are wider than a word on hosted
+ * builds and stats keep an enqueue timestamp after the messages.
+ */
+#if defined(OS_CONFIG_QUEUE_STATS)
+#define OS_QUEUE_SLOT_WORDS ((sizeof(void *) + sizeof(uint32_t)) / sizeof(uint32_t))
+#else
+#define OS_QUEUE_SLOT_WORDS (sizeof(void *) / sizeof(uint32_t))
+#endif
+
+#define OS_LOCK_KIND_MUTEX     (0)
+#define OS_LOCK_KIND_SEMAPHORE (1)
+#define OS_LOCK_KIND_RWLOCK    (2)
+
+/**
+ * Times are in microseconds. Waits are counted for every acquisition that
+ * had to block, including those that timed out. Holds are only counted for
+ * locks with a single owner, so mutexes and rwlock writers.
+ */
+typedef struct os_lock_stats_t {
+    const char *name;
+    uint8_t kind;
+    uint32_t acquisitions;
+    uint32_t contended;
+    uint32_t timeouts;
+    uint64_t wait_total;
+    uint32_t wait_max;
+    uint64_t hold_total;
+    uint32_t hold_max;
+    os_task_t *worst_owner; //! Owner during the longest hold. */
+    os_task_t *holder;
+    uint32_t held_since;
+} os_lock_stats_t;
+
 #define OS_MUTEX_FLAG_NONE             (0)
 #define OS_MUTEX_FLAG_ABORT_ON_TIMEOUT (1)
+/* Set until the next owner is told, see os_mutex_acquire. */
+#define OS_MUTEX_FLAG_OWNER_DIED       (2)
 
 /**
  *
@@ -250,6 +438,10 @@ typedef struct os_mutex_t {
     os_task_t *owner;
     uint16_t level;
     uint32_t flags;
+    struct os_mutex_t *next; //! Next in osg.mutexes. */
+#if defined(OS_CONFIG_LOCK_STATS)
+    os_lock_stats_t stats;
+#endif
 } os_mutex_t;
 
 /**
@@ -269,8 +461,22 @@ typedef struct os_semaphore_t {
     os_blocked_t blocked;
     uint32_t tokens;
     uint32_t flags;
+    struct os_semaphore_t *next; //! Next in osg.semaphores. */
+#if defined(OS_CONFIG_LOCK_STATS)
+    os_lock_stats_t stats;
+#endif
 } os_semaphore_t;
 
+/**
+ * Policy for deciding who gets a rwlock when both readers and writers are
+ * waiting. Readers are preferred by default, which can starve writers.
+ */
+#define OS_RWLOCK_FLAG_NONE           (0)
+#define OS_RWLOCK_FLAG_PREFER_READERS (0)
+#define OS_RWLOCK_FLAG_PREFER_WRITERS (1)
+#define OS_RWLOCK_FLAG_PHASE_FAIR     (2)
+#define OS_RWLOCK_FLAG_POLICY_MASK    (3)
+
 /**
  *
  */
@@ -289,8 +495,75 @@ typedef struct os_rwlock_t {
     uint16_t writers;
     uint32_t flags;
     os_task_t *writer;
+    os_task_t *upgrader;
+    struct os_rwlock_t *next; //! Next in osg.rwlocks. */
+#if defined(OS_CONFIG_LOCK_STATS)
+    os_lock_stats_t stats;
+#endif
 } os_rwlock_t;
 
+/**
+ * Deadline is the uptime the next check-in is due by.
+ */
+typedef struct os_watchdog_t {
+    os_task_t *task;
+    uint32_t period;
+    uint32_t deadline;
+    struct os_watchdog_t *next; //! Next in osg.watchdogs. */
+} os_watchdog_t;
+
+/**
+ * When a supervised task stops: permanent ones are always restarted,
+ * transient ones only if they panicked or aborted and temporary ones never.
+ */
+typedef enum os_restart_t {
+    OS_RESTART_PERMANENT,
+    OS_RESTART_TRANSIENT,
+    OS_RESTART_TEMPORARY,
+} os_restart_t;
+
+/**
+ * Most restarts a supervisor can be allowed within its period.
+ */
+#define OS_SUPERVISOR_INTENSITY_MAX (8)
+
+typedef struct os_supervisor_child_t {
+    os_task_t *task;
+    os_restart_t restart;
+    os_priority_t priority; //! Priority to restart with. */
+    uint32_t restarts;
+    struct os_supervisor_child_t *next;
+} os_supervisor_child_t;
+
+/**
+ * Restarts are one for one, only the task that stopped is restarted. More
+ * than intensity restarts within period ms and the supervisor gives up.
+ */
+typedef struct os_supervisor_t {
+    const char *name;
+    uint8_t intensity;
+    uint32_t period;
+    uint8_t nrestarts;
+    uint8_t restart;                              //! Oldest entry in restarted once it's full. */
+    uint32_t restarted[OS_SUPERVISOR_INTENSITY_MAX]; //! Uptime of recent restarts. */
+    bool failed;
+    os_supervisor_child_t *children;
+    struct os_supervisor_t *next; //! Next in osg.supervisors. */
+} os_supervisor_t;
+
+/**
+ * Messages a task logs with os_printf, only the owning task writes and only
+ * the logger reads.
+ */
+typedef struct os_logger_ring_t {
+    char *buffer;
+    uint32_t size;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+    uint32_t reported;
+} os_logger_ring_t;
+
 /**
  *
  */
@@ -317,8 +590,22 @@ typedef struct os_globals_t {
     os_task_t *tasks;     //! Immutable, every task in order of creation. */
     os_task_t *runqueue;  //! Queue of tasks waiting for a turn to run. */
     os_task_t *waitqueue; //! Tasks waiting for something. */
+    os_task_t *deferred;  //! Highest priority task woken from an IRQ or while locked. */
+    bool reschedule;      //! Scheduling was skipped because the scheduler was locked. */
     os_task_status_hook_fn_t status_hook;
     os_logging_hook_fn_t logging_hook;
+    struct os_queue_t *queues;         //! Every queue created, newest first. */
+    struct os_mutex_t *mutexes;        //! Every mutex created, newest first. */
+    struct os_semaphore_t *semaphores; //! Every semaphore created, newest first. */
+    struct os_rwlock_t *rwlocks;       //! Every rwlock created, newest first. */
+    os_task_t *stack_scan;             //! Task os_stack_scan is working through. */
+#if defined(OS_CONFIG_WATCHDOG)
+    os_watchdog_t *watchdogs;        //! Every registered watchdog, newest first. */
+    os_watchdog_t *watchdog_overdue; //! First to miss a check-in, feeding stops for good. */
+#endif
+#if defined(OS_CONFIG_SUPERVISOR)
+    os_supervisor_t *supervisors; //! Every supervisor created, newest first. */
+#endif
 } os_globals_t;
 
 /**
@@ -329,13 +616,14 @@ extern os_globals_t osg;
 /* TODO: typedef enum here breaks in the service call macro magic. */
 typedef uint32_t os_status_t;
 
-#define OSS_SUCCESS       (0x0) /** Successful call. */
-#define OSS_ERROR         (0x1) /** A generic error. */
-#define OSS_ERROR_TO      (0x2) /** Timeout related rror. */
-#define OSS_ERROR_MEM     (0x3) /** Insufficient memory. */
-#define OSS_ERROR_INT     (0x4) /** Operation was interrupted. */
-#define OSS_ERROR_INVALID (0x5) /** Invalid operation. */
-#define OSS_ERROR_NOP     (0x6) /** No operation. */
+#define OSS_SUCCESS          (0x0) /** Successful call. */
+#define OSS_ERROR            (0x1) /** A generic error. */
+#define OSS_ERROR_TO         (0x2) /** Timeout related rror. */
+#define OSS_ERROR_MEM        (0x3) /** Insufficient memory. */
+#define OSS_ERROR_INT        (0x4) /** Operation was interrupted. */
+#define OSS_ERROR_INVALID    (0x5) /** Invalid operation. */
+#define OSS_ERROR_NOP        (0x6) /** No operation. */
+#define OSS_ERROR_OWNER_DIED (0x7) /** Acquired, though the last owner stopped while holding it. */
 
 /**
  * Tuple for returning multiple values from a service call. This is modified in
@@ -0,0 +1,127 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+#include "internal.h"
+
+#if defined(OS_CONFIG_WATCHDOG)
+
+static bool is_late(uint32_t now, uint32_t deadline) {
+    return (int32_t)(now - deadline) > 0;
+}
+
+static bool is_supervised(os_task_t *task) {
+    return os_task_status_is_running(task->status) || task->status == OS_TASK_STATUS_WAIT;
+}
+
+os_status_t os_watchdog_start(uint32_t timeout) {
+    OS_ASSERT(timeout > 0);
+
+    return osi_platform_watchdog_start(timeout);
+}
+
+os_status_t os_watchdog_register(os_watchdog_t *watchdog, os_task_t *task, uint32_t period) {
+    OS_ASSERT(watchdog != NULL);
+    OS_ASSERT(task != NULL);
+    OS_ASSERT(period > 0);
+
+    watchdog->task = task;
+    watchdog->period = period;
+    watchdog->deadline = os_uptime() + period;
+
+    OS_LOCK();
+
+    // Registering the same watchdog again mustn't link it twice.
+    bool found = false;
+    for (os_watchdog_t *iter = osg.watchdogs; iter != NULL; iter = iter->next) {
+        if (iter == watchdog) {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        watchdog->next = osg.watchdogs;
+        osg.watchdogs = watchdog;
+    }
+
+    OS_UNLOCK();
+
+    return OSS_SUCCESS;
+}
+
+os_status_t os_watchdog_unregister(os_watchdog_t *watchdog) {
+    OS_ASSERT(watchdog != NULL);
+
+    os_status_t err = OSS_ERROR_INVALID;
+
+    OS_LOCK();
+
+    os_watchdog_t *previous = NULL;
+    for (os_watchdog_t *iter = osg.watchdogs; iter != NULL; iter = iter->next) {
+        if (iter == watchdog) {
+            if (previous == NULL) {
+                osg.watchdogs = iter->next;
+            } else {
+                previous->next = iter->next;
+            }
+            iter->next = NULL;
+            err = OSS_SUCCESS;
+            break;
+        }
+        previous = iter;
+    }
+
+    OS_UNLOCK();
+
+    return err;
+}
+
+os_status_t os_watchdog_checkin(os_watchdog_t *watchdog) {
+    OS_ASSERT(watchdog != NULL);
+
+    watchdog->deadline = os_uptime() + watchdog->period;
+
+    return OSS_SUCCESS;
+}
+
+os_watchdog_t *os_watchdog_overdue() {
+    return osg.watchdog_overdue;
+}
+
+void osi_watchdog_supervise() {
+    if (osg.watchdog_overdue != NULL) {
+        return;
+    }
+
+    uint32_t now = os_uptime();
+    for (os_watchdog_t *iter = osg.watchdogs; iter != NULL; iter = iter->next) {
+        if (!is_supervised(iter->task)) {
+            iter->deadline = now + iter->period;
+            continue;
+        }
+        if (is_late(now, iter->deadline)) {
+            osg.watchdog_overdue = iter;
+            osi_printf("watchdog: '%s' missed its check-in\n", iter->task->name);
+#if defined(OS_CONFIG_CRASH_SNAPSHOT)
+            // The hardware is going to reset us, this is our last chance.
+            osi_crash_capture(OS_PANIC_WATCHDOG, NULL, 0, NULL);
+#endif
+            return;
+        }
+    }
+
+    osi_platform_watchdog_feed();
+}
+
+#endif
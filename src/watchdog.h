@@ -0,0 +1,67 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_WATCHDOG_H
+#define OS_WATCHDOG_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#if defined(OS_CONFIG_WATCHDOG)
+
+/**
+ * Enable the hardware watchdog with the given timeout in ms. From here on
+ * it's fed from SysTick for as long as every registered task checks in on
+ * time, so this should be comfortably longer than a tick.
+ */
+os_status_t os_watchdog_start(uint32_t timeout);
+
+/**
+ * Supervise task, which has to call os_watchdog_checkin at least every
+ * period ms. The first check-in is due a period from now. Tasks that are
+ * suspended or have stopped are left alone and get a whole period again
+ * once they're back.
+ */
+os_status_t os_watchdog_register(os_watchdog_t *watchdog, os_task_t *task, uint32_t period);
+
+/**
+ *
+ */
+os_status_t os_watchdog_unregister(os_watchdog_t *watchdog);
+
+/**
+ * Safe to call from the task or an IRQ, this is a single store.
+ */
+os_status_t os_watchdog_checkin(os_watchdog_t *watchdog);
+
+/**
+ * The first watchdog to miss its check-in, or NULL if all is well. Once a
+ * task is late the hardware watchdog is never fed again, so this is the
+ * task that's about to cause a reset.
+ */
+os_watchdog_t *os_watchdog_overdue();
+
+/**
+ * Check every watchdog and feed the hardware if they're all on time, the
+ * first to be late is recorded in a crash snapshot.
+ */
+void osi_watchdog_supervise();
+
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+#include <cstdlib>
+
+#include "kernel.h"
+
+static void task_handler_bench(void *params) {
+}
+
+Kernel::Kernel(size_t tasks) : tasks_(tasks), stacks_(tasks * OS_STACK_MINIMUM_SIZE_WORDS) {
+    tests_platform_time(0);
+
+    OS_ASSERT(os_initialize() == OSS_SUCCESS);
+    for (size_t i = 0; i < tasks; ++i) {
+        uint32_t *stack = &stacks_[i * OS_STACK_MINIMUM_SIZE_WORDS];
+        OS_ASSERT(os_task_initialize(&tasks_[i], i == 0 ? "idle" : "task", OS_TASK_START_RUNNING, &task_handler_bench, NULL, stack,
+                                     OS_STACK_MINIMUM_SIZE) == OSS_SUCCESS);
+    }
+    OS_ASSERT(os_start() == OSS_SUCCESS);
+    schedule_and_switch();
+}
+
+Kernel::~Kernel() {
+    os_teardown();
+}
+
+os_task_t *Kernel::switch_task() {
+    if (osg.scheduled != NULL) {
+        osg.running = osg.scheduled;
+        osg.scheduled = NULL;
+    }
+    return running();
+}
+
+os_task_t *Kernel::schedule_and_switch() {
+    osi_schedule();
+    return switch_task();
+}
+
+void Kernel::sleep(os_task_t *task, uint32_t until) {
+    task->delay = until;
+    osi_task_status_set(task, OS_TASK_STATUS_WAIT);
+}
+
+extern "C" {
+
+void osi_assert(const char *assertion, const char *file, int line) {
+    fprintf(stderr, "assertion \"%s\" failed: file \"%s\", line %d\n", assertion, file, line);
+    abort();
+}
+}
@@ -0,0 +1,61 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_BENCH_KERNEL_H
+#define OS_BENCH_KERNEL_H
+
+#include <vector>
+
+#include <os.h>
+#include <internal.h>
+
+/**
+ * Stands in for the PendSV/SVC handlers like the hosted tests do, there's
+ * only ever one of these since the kernel state is global.
+ */
+class Kernel {
+public:
+    /**
+     * Starts the idle task and tasks - 1 workers at normal priority and
+     * switches to the first worker.
+     */
+    explicit Kernel(size_t tasks);
+    ~Kernel();
+
+public:
+    os_task_t *task(size_t i) {
+        return &tasks_[i];
+    }
+
+    os_task_t *running() {
+        return (os_task_t *)osg.running;
+    }
+
+    /**
+     * Finish a switch the kernel has asked for, if any.
+     */
+    os_task_t *switch_task();
+
+    os_task_t *schedule_and_switch();
+
+    /**
+     * Puts a worker to sleep until the given time without switching away.
+     */
+    void sleep(os_task_t *task, uint32_t until);
+
+private:
+    std::vector<os_task_t> tasks_;
+    std::vector<uint32_t> stacks_;
+};
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include "kernel.h"
+
+static void Mutex_Uncontended(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "mutex", 0 };
+    OS_ASSERT(osi_mutex_create(&mutex, &def) == OSS_SUCCESS);
+
+    for (auto _ : state) {
+        osi_mutex_acquire(&mutex, 500);
+        osi_mutex_release(&mutex);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Mutex_Uncontended);
+
+/**
+ * The owner is preempted, the other worker blocks acquiring and the owner
+ * hands the mutex over, so ownership swaps every iteration. Includes the
+ * three switches.
+ */
+static void Mutex_Contended(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "mutex", 0 };
+    OS_ASSERT(osi_mutex_create(&mutex, &def) == OSS_SUCCESS);
+
+    osi_mutex_acquire(&mutex, 500);
+
+    for (auto _ : state) {
+        os_task_t *waiter = kernel.schedule_and_switch();
+        osi_task_set_stacked_return(waiter, OSS_ERROR_TO);
+        osi_mutex_acquire(&mutex, 500);
+        kernel.switch_task();
+        osi_mutex_release(&mutex);
+        kernel.switch_task();
+    }
+
+    if (mutex.owner != kernel.running() || mutex.blocked.tasks != NULL) {
+        state.SkipWithError("mutex wasn't handed over");
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Mutex_Contended);
+
+static void Semaphore_Uncontended(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_semaphore_t semaphore;
+    os_semaphore_definition_t def = { "semaphore", 1, 0 };
+    OS_ASSERT(osi_semaphore_create(&semaphore, &def) == OSS_SUCCESS);
+
+    for (auto _ : state) {
+        osi_semaphore_acquire(&semaphore, 500);
+        osi_semaphore_release(&semaphore);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Semaphore_Uncontended);
+
+/**
+ * Like Mutex_Contended, the only token is handed over every iteration.
+ */
+static void Semaphore_Contended(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_semaphore_t semaphore;
+    os_semaphore_definition_t def = { "semaphore", 1, 0 };
+    OS_ASSERT(osi_semaphore_create(&semaphore, &def) == OSS_SUCCESS);
+
+    osi_semaphore_acquire(&semaphore, 500);
+
+    for (auto _ : state) {
+        os_task_t *waiter = kernel.schedule_and_switch();
+        osi_task_set_stacked_return(waiter, OSS_ERROR_TO);
+        osi_semaphore_acquire(&semaphore, 500);
+        kernel.switch_task();
+        osi_semaphore_release(&semaphore);
+        kernel.switch_task();
+    }
+
+    if (semaphore.tokens != 0 || semaphore.blocked.tasks != NULL) {
+        state.SkipWithError("token wasn't handed over");
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Semaphore_Contended);
+
+static void RwLock_UncontendedRead(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PREFER_READERS };
+    OS_ASSERT(osi_rwlock_create(&rwlock, &def) == OSS_SUCCESS);
+
+    for (auto _ : state) {
+        osi_rwlock_acquire_read(&rwlock, 500);
+        osi_rwlock_release(&rwlock);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(RwLock_UncontendedRead);
+
+static void RwLock_UncontendedWrite(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PREFER_READERS };
+    OS_ASSERT(osi_rwlock_create(&rwlock, &def) == OSS_SUCCESS);
+
+    for (auto _ : state) {
+        osi_rwlock_acquire_write(&rwlock, 500);
+        osi_rwlock_release(&rwlock);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(RwLock_UncontendedWrite);
+
+/**
+ * Like Mutex_Contended with writers, the lock is handed from one writer to
+ * the other every iteration.
+ */
+static void RwLock_ContendedWrite(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PREFER_WRITERS };
+    OS_ASSERT(osi_rwlock_create(&rwlock, &def) == OSS_SUCCESS);
+
+    osi_rwlock_acquire_write(&rwlock, 500);
+
+    for (auto _ : state) {
+        os_task_t *waiter = kernel.schedule_and_switch();
+        osi_task_set_stacked_return(waiter, OSS_ERROR_TO);
+        osi_rwlock_acquire_write(&rwlock, 500);
+        kernel.switch_task();
+        osi_rwlock_release(&rwlock);
+        kernel.switch_task();
+    }
+
+    if (rwlock.writer != kernel.running() || rwlock.blocked.tasks != NULL) {
+        state.SkipWithError("rwlock wasn't handed over");
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(RwLock_ContendedWrite);
@@ -0,0 +1,36 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+/**
+ * JSON unless asked otherwise, so runs can be kept and compared with
+ * tools/compare.py from Google Benchmark.
+ */
+int main(int argc, char **argv) {
+    static char json[] = "--benchmark_format=json";
+
+    std::vector<char *> args(argv, argv + argc);
+    args.insert(args.begin() + 1, json);
+    argc = (int)args.size();
+
+    benchmark::Initialize(&argc, args.data());
+    if (benchmark::ReportUnrecognizedArguments(argc, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include <os.h>
+#include <printf.h>
+
+static int format(char *buffer, size_t size, const char *f, ...) {
+    va_list args;
+    va_start(args, f);
+    int n = os_vsnprintf(buffer, size, f, args);
+    va_end(args);
+    return n;
+}
+
+/**
+ * Something like a typical log line.
+ */
+static void Printf_Mixed(benchmark::State &state) {
+    char buffer[128];
+    int64_t bytes = 0;
+
+    for (auto _ : state) {
+        bytes += format(buffer, sizeof(buffer), "%s: [%08x] %d/%u (%s) %c\n", "task", 0xcafe, -1234, 5678u, "OSS_SUCCESS", '!');
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(Printf_Mixed);
+
+static void Printf_Integers(benchmark::State &state) {
+    char buffer[128];
+    int64_t bytes = 0;
+
+    for (auto _ : state) {
+        bytes += format(buffer, sizeof(buffer), "%d %d %u %u %x %x", 0, -2147483647, 42u, 4294967295u, 0x10u, 0xdeadbeefu);
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(Printf_Integers);
+
+static void Printf_Strings(benchmark::State &state) {
+    char buffer[128];
+    int64_t bytes = 0;
+
+    for (auto _ : state) {
+        bytes += format(buffer, sizeof(buffer), "%s %-12s %12s", "a somewhat longer string", "left", "right");
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(Printf_Strings);
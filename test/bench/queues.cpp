@@ -0,0 +1,104 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include "kernel.h"
+
+static const char *message = "message";
+
+/**
+ * Nobody is waiting on either end.
+ */
+static void Queue_EnqueueDequeue(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_queue_define(queue, 4, OS_QUEUE_FLAGS_NONE);
+    OS_ASSERT(osi_queue_create(os_queue(queue), os_queue_def(queue)) == OSS_SUCCESS);
+
+    void *received = NULL;
+    for (auto _ : state) {
+        osi_queue_enqueue(os_queue(queue), (void *)message, 0);
+        osi_queue_dequeue(os_queue(queue), &received, 0);
+        benchmark::DoNotOptimize(received);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Queue_EnqueueDequeue);
+
+/**
+ * The receiver is always blocked on an empty queue, so each message is
+ * handed straight to it. Includes both switches and the receiver blocking
+ * again.
+ */
+static void Queue_EnqueueToBlockedReceiver(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_queue_define(queue, 4, OS_QUEUE_FLAGS_NONE);
+    OS_ASSERT(osi_queue_create(os_queue(queue), os_queue_def(queue)) == OSS_SUCCESS);
+
+    os_task_t *receiver = kernel.running();
+    void *received = NULL;
+    osi_task_set_stacked_return(receiver, OSS_ERROR_TO);
+    osi_queue_dequeue(os_queue(queue), &received, 500);
+    os_task_t *sender = kernel.switch_task();
+
+    for (auto _ : state) {
+        osi_queue_enqueue(os_queue(queue), (void *)message, 500);
+        kernel.switch_task();
+        osi_task_set_stacked_return(receiver, OSS_ERROR_TO);
+        osi_queue_dequeue(os_queue(queue), &received, 500);
+        kernel.switch_task();
+    }
+
+    if (kernel.running() != sender || os_queue(queue)->blocked.tasks != receiver) {
+        state.SkipWithError("receiver wasn't blocked");
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Queue_EnqueueToBlockedReceiver);
+
+/**
+ * The sender is always blocked on a full queue, so each dequeue makes room
+ * for it. Includes both switches and the sender blocking again.
+ */
+static void Queue_DequeueFromBlockedSender(benchmark::State &state) {
+    Kernel kernel(3);
+
+    os_queue_define(queue, 1, OS_QUEUE_FLAGS_NONE);
+    OS_ASSERT(osi_queue_create(os_queue(queue), os_queue_def(queue)) == OSS_SUCCESS);
+
+    os_task_t *sender = kernel.running();
+    osi_queue_enqueue(os_queue(queue), (void *)message, 500);
+    osi_task_set_stacked_return(sender, OSS_ERROR_TO);
+    osi_queue_enqueue(os_queue(queue), (void *)message, 500);
+    os_task_t *receiver = kernel.switch_task();
+
+    void *received = NULL;
+    for (auto _ : state) {
+        osi_queue_dequeue(os_queue(queue), &received, 500);
+        kernel.switch_task();
+        osi_task_set_stacked_return(sender, OSS_ERROR_TO);
+        osi_queue_enqueue(os_queue(queue), (void *)message, 500);
+        kernel.switch_task();
+    }
+
+    if (kernel.running() != receiver || os_queue(queue)->blocked.tasks != sender) {
+        state.SkipWithError("sender wasn't blocked");
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Queue_DequeueFromBlockedSender);
@@ -0,0 +1,97 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <benchmark/benchmark.h>
+
+#include "kernel.h"
+
+/**
+ * Round robin between workers of the same priority, the argument is the
+ * number of tasks including idle.
+ */
+static void Scheduler_Schedule(benchmark::State &state) {
+    Kernel kernel(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kernel.schedule_and_switch());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Scheduler_Schedule)->RangeMultiplier(2)->Range(4, 128);
+
+/**
+ * Two workers taking turns while the rest sleep, every schedule walks the
+ * waitqueue looking for somebody to wake.
+ */
+static void Scheduler_ScheduleWithSleepers(benchmark::State &state) {
+    Kernel kernel(state.range(0));
+
+    for (size_t i = 3; i < (size_t)state.range(0); ++i) {
+        kernel.sleep(kernel.task(i), 1000 + i);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kernel.schedule_and_switch());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Scheduler_ScheduleWithSleepers)->RangeMultiplier(2)->Range(4, 128);
+
+/**
+ * Hand the CPU to each worker in turn, without looking for them first.
+ */
+static void Scheduler_Dispatch(benchmark::State &state) {
+    Kernel kernel(state.range(0));
+    size_t workers = state.range(0) - 1;
+    size_t next = 0;
+
+    for (auto _ : state) {
+        os_task_t *task = kernel.task(1 + next);
+        if (task == kernel.running()) {
+            next = (next + 1) % workers;
+            task = kernel.task(1 + next);
+        }
+        osi_dispatch(task);
+        benchmark::DoNotOptimize(kernel.switch_task());
+        next = (next + 1) % workers;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Scheduler_Dispatch)->RangeMultiplier(2)->Range(4, 128);
+
+/**
+ * A worker going to sleep and being woken while the argument's worth of
+ * other tasks are asleep, its wake up time lands in the middle of theirs.
+ */
+static void Scheduler_WaitQueue(benchmark::State &state) {
+    size_t sleepers = state.range(0);
+    Kernel kernel(sleepers + 3);
+
+    for (size_t i = 0; i < sleepers; ++i) {
+        kernel.sleep(kernel.task(3 + i), 1000 + i * 2);
+    }
+
+    os_task_t *task = kernel.task(2);
+    OS_ASSERT(task != kernel.running());
+
+    for (auto _ : state) {
+        kernel.sleep(task, 1000 + sleepers);
+        osi_task_status_set(task, OS_TASK_STATUS_IDLE);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Scheduler_WaitQueue)->RangeMultiplier(4)->Range(1, 128);
@@ -0,0 +1,80 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "schedfuzz.h"
+
+/**
+ * Stands in for libFuzzer's main when building with gcc or for AFL, runs
+ * each file given, or stdin, once. With --random it makes its own inputs
+ * instead, which is what ctest does.
+ */
+static int run_file(FILE *fp, bool verbose) {
+    std::vector<uint8_t> data;
+    uint8_t buffer[256];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    return schedfuzz_run(data.data(), data.size(), verbose);
+}
+
+static int run_random(uint32_t iterations, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data;
+    for (uint32_t i = 0; i < iterations; ++i) {
+        data.resize(16 + rng() % 1024);
+        for (auto &byte : data) {
+            byte = (uint8_t)rng();
+        }
+        schedfuzz_run(data.data(), data.size(), false);
+    }
+    printf("schedfuzz: %u random inputs from seed %u\n", iterations, seed);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    bool verbose = false;
+    int i = 1;
+    if (i < argc && strcmp(argv[i], "-v") == 0) {
+        verbose = true;
+        i++;
+    }
+
+    if (i < argc && strcmp(argv[i], "--random") == 0) {
+        uint32_t iterations = i + 1 < argc ? (uint32_t)strtoul(argv[i + 1], NULL, 10) : 1000;
+        uint32_t seed = i + 2 < argc ? (uint32_t)strtoul(argv[i + 2], NULL, 10) : 1;
+        return run_random(iterations, seed);
+    }
+
+    if (i == argc) {
+        return run_file(stdin, verbose);
+    }
+
+    for (; i < argc; ++i) {
+        FILE *fp = fopen(argv[i], "rb");
+        if (fp == NULL) {
+            fprintf(stderr, "schedfuzz: unable to open %s\n", argv[i]);
+            return 2;
+        }
+        run_file(fp, verbose);
+        fclose(fp);
+    }
+
+    return 0;
+}
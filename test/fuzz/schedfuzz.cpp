@@ -0,0 +1,499 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <os.h>
+#include <internal.h>
+
+#include "schedfuzz.h"
+
+/**
+ * Workers besides the idle task, enough for every kind of contention.
+ */
+#define SCHEDFUZZ_WORKERS_MAX (6)
+
+/**
+ * Inputs are cut off after this many operations to keep runs fast.
+ */
+#define SCHEDFUZZ_OPERATIONS_MAX (512)
+
+enum class Operation : uint8_t {
+    Tick,
+    Delay,
+    Suspend,
+    Resume,
+    Abort,
+    Restart,
+    Enqueue,
+    Dequeue,
+    MutexAcquire,
+    MutexRelease,
+    SemaphoreAcquire,
+    SemaphoreRelease,
+    RwLockRead,
+    RwLockWrite,
+    RwLockRelease,
+    Isr,
+    Yield,
+    Count,
+};
+
+static const char *operation_names[] = {
+    "tick",          "delay",           "suspend",        "resume",       "abort",       "restart",         "enqueue", "dequeue",
+    "mutex-acquire", "mutex-release",   "sem-acquire",    "sem-release",  "rw-read",     "rw-write",        "rw-release", "isr",
+    "yield",
+};
+
+static_assert(sizeof(operation_names) / sizeof(operation_names[0]) == (size_t)Operation::Count, "operation names");
+
+class Input {
+public:
+    Input(const uint8_t *data, size_t size) : data_(data), size_(size) {
+    }
+
+public:
+    bool empty() const {
+        return position_ >= size_;
+    }
+
+    uint8_t byte() {
+        return empty() ? 0 : data_[position_++];
+    }
+
+private:
+    const uint8_t *data_;
+    size_t size_;
+    size_t position_{ 0 };
+};
+
+class Harness {
+public:
+    Harness(Input &input, bool verbose);
+    ~Harness();
+
+public:
+    void run();
+
+private:
+    void operation(Operation op, uint8_t argument);
+    void settle();
+    os_task_t *worker(uint8_t argument);
+    uint32_t timeout(uint8_t argument);
+    bool running_is_idle();
+
+    void check_structure();
+    void check_scheduled();
+    void check_lists();
+    void check_blocked();
+    void fail(const char *invariant, os_task_t *task);
+
+private:
+    Input &input_;
+    bool verbose_;
+    size_t nworkers_;
+    os_task_t tasks_[SCHEDFUZZ_WORKERS_MAX + 1];
+    uint32_t stacks_[SCHEDFUZZ_WORKERS_MAX + 1][OS_STACK_MINIMUM_SIZE_WORDS];
+    uint32_t now_{ 0 };
+    std::vector<std::string> log_;
+
+    uint32_t queue_storage_[os_word_size(os_queue_t) + 2 * OS_QUEUE_SLOT_WORDS];
+    os_queue_definition_t queue_def_{ "queue", 2, OS_QUEUE_FLAGS_NONE };
+    os_mutex_t mutex_;
+    os_mutex_definition_t mutex_def_{ "mutex", 0 };
+    os_semaphore_t semaphore_;
+    os_semaphore_definition_t semaphore_def_{ "semaphore", 1, 0 };
+    os_rwlock_t rwlock_;
+    os_rwlock_definition_t rwlock_def_{ "rwlock", OS_RWLOCK_FLAG_PREFER_READERS };
+};
+
+static void task_handler_fuzz(void *params) {
+}
+
+static const char *task_names[] = { "idle", "task-1", "task-2", "task-3", "task-4", "task-5", "task-6" };
+
+/**
+ * The first bytes pick how many workers there are, their priorities and
+ * the rwlock's policy.
+ */
+Harness::Harness(Input &input, bool verbose) : input_(input), verbose_(verbose) {
+    nworkers_ = 1 + input_.byte() % SCHEDFUZZ_WORKERS_MAX;
+    rwlock_def_.flags = input_.byte() % 3;
+
+    tests_platform_time(0);
+    OS_ASSERT(os_initialize() == OSS_SUCCESS);
+
+    for (size_t i = 0; i <= nworkers_; ++i) {
+        os_priority_t priority = i == 0 ? OS_PRIORITY_IDLE : (os_priority_t)(OS_PRIORITY_NORMAL + input_.byte() % 4);
+        os_task_options_t options = { task_names[i], OS_TASK_START_RUNNING, &task_handler_fuzz, NULL, stacks_[i], sizeof(stacks_[i]),
+                                      priority, 0 };
+        OS_ASSERT(os_task_initialize_options(&tasks_[i], &options) == OSS_SUCCESS);
+    }
+
+    os_queue_t *queue = (os_queue_t *)queue_storage_;
+    OS_ASSERT(osi_queue_create(queue, &queue_def_) == OSS_SUCCESS);
+    OS_ASSERT(osi_mutex_create(&mutex_, &mutex_def_) == OSS_SUCCESS);
+    OS_ASSERT(osi_semaphore_create(&semaphore_, &semaphore_def_) == OSS_SUCCESS);
+    OS_ASSERT(osi_rwlock_create(&rwlock_, &rwlock_def_) == OSS_SUCCESS);
+
+    OS_ASSERT(os_start() == OSS_SUCCESS);
+    osi_schedule();
+    settle();
+}
+
+Harness::~Harness() {
+    os_teardown();
+}
+
+void Harness::run() {
+    for (size_t i = 0; i < SCHEDFUZZ_OPERATIONS_MAX && !input_.empty(); ++i) {
+        Operation op = (Operation)(input_.byte() % (uint8_t)Operation::Count);
+        uint8_t argument = input_.byte();
+
+        char entry[64];
+        snprintf(entry, sizeof(entry), "%4u %-10s %-14s %3d", now_, osg.running->name, operation_names[(size_t)op], argument);
+        log_.push_back(entry);
+        if (verbose_) {
+            fprintf(stderr, "%s\n", entry);
+        }
+
+        operation(op, argument);
+        settle();
+
+        check_structure();
+        if (op == Operation::Tick || op == Operation::Yield) {
+            check_scheduled();
+        }
+    }
+}
+
+/**
+ * Everything here happens as the running task, or from an IRQ, the way an
+ * application would call into the kernel.
+ */
+void Harness::operation(Operation op, uint8_t argument) {
+    os_task_t *running = (os_task_t *)osg.running;
+    os_queue_t *queue = (os_queue_t *)queue_storage_;
+
+    // Blocking calls need somewhere to put the result for when we resume.
+    osi_task_set_stacked_return(running, OSS_ERROR_TO);
+
+    switch (op) {
+    case Operation::Tick: {
+        now_ += 1 + argument % 8;
+        tests_platform_time(now_);
+        if (osg.scheduled == NULL) {
+            osi_schedule();
+        }
+        break;
+    }
+    case Operation::Delay: {
+        if (!running_is_idle()) {
+            svc_delay(1 + argument % 16);
+        }
+        break;
+    }
+    case Operation::Suspend: {
+        // Suspending yourself doesn't give up the CPU until the next tick,
+        // so only suspend others.
+        os_task_t *task = worker(argument);
+        if (task != running && os_task_status_is_running(task->status)) {
+            os_task_suspend(task);
+        }
+        break;
+    }
+    case Operation::Resume: {
+        os_task_t *task = worker(argument);
+        if (task->status == OS_TASK_STATUS_SUSPENDED) {
+            os_task_resume(task);
+        }
+        break;
+    }
+    case Operation::Abort: {
+        // Whatever it holds is handed on.
+        if (!running_is_idle()) {
+            svc_abort(0);
+        }
+        break;
+    }
+    case Operation::Restart: {
+        os_task_t *task = worker(argument);
+        if (task->status == OS_TASK_STATUS_ABORTED) {
+            os_task_start(task);
+        }
+        break;
+    }
+    case Operation::Enqueue: {
+        osi_queue_enqueue(queue, (void *)(uintptr_t)argument, timeout(argument));
+        break;
+    }
+    case Operation::Dequeue: {
+        void *message = NULL;
+        osi_queue_dequeue(queue, &message, timeout(argument));
+        break;
+    }
+    case Operation::MutexAcquire: {
+        osi_mutex_acquire(&mutex_, timeout(argument));
+        break;
+    }
+    case Operation::MutexRelease: {
+        if (mutex_.owner == running) {
+            osi_mutex_release(&mutex_);
+        }
+        break;
+    }
+    case Operation::SemaphoreAcquire: {
+        osi_semaphore_acquire(&semaphore_, timeout(argument));
+        break;
+    }
+    case Operation::SemaphoreRelease: {
+        osi_semaphore_release(&semaphore_);
+        break;
+    }
+    case Operation::RwLockRead: {
+        osi_rwlock_acquire_read(&rwlock_, timeout(argument));
+        break;
+    }
+    case Operation::RwLockWrite: {
+        osi_rwlock_acquire_write(&rwlock_, timeout(argument));
+        break;
+    }
+    case Operation::RwLockRelease: {
+        if (rwlock_.writer == running || osi_rwlock_read_depth(&rwlock_, running) > 0) {
+            osi_rwlock_release(&rwlock_);
+        }
+        break;
+    }
+    case Operation::Isr: {
+        if (argument & 1) {
+            osi_semaphore_release_isr(&semaphore_);
+        } else {
+            osi_queue_enqueue_isr(queue, (void *)(uintptr_t)argument);
+        }
+        osi_pendsv();
+        break;
+    }
+    case Operation::Yield: {
+        if (osg.scheduled == NULL) {
+            osi_schedule();
+        }
+        break;
+    }
+    case Operation::Count: {
+        break;
+    }
+    }
+}
+
+/**
+ * Does what PendSV would.
+ */
+void Harness::settle() {
+    if (osg.scheduled != NULL) {
+        osg.running = osg.scheduled;
+        osg.scheduled = NULL;
+    }
+}
+
+os_task_t *Harness::worker(uint8_t argument) {
+    return &tasks_[1 + argument % nworkers_];
+}
+
+/**
+ * The idle task mustn't block, everybody else sometimes does.
+ */
+uint32_t Harness::timeout(uint8_t argument) {
+    if (running_is_idle() || (argument & 0x80) == 0) {
+        return 0;
+    }
+    return 1 + argument % 32;
+}
+
+bool Harness::running_is_idle() {
+    return osg.running == &tasks_[0];
+}
+
+void Harness::check_structure() {
+    check_lists();
+    check_blocked();
+}
+
+/**
+ * Once the kernel has had its chance to schedule, the running task is
+ * active and nothing that's ready outranks it.
+ */
+void Harness::check_scheduled() {
+    os_task_t *running = (os_task_t *)osg.running;
+    if (running->status != OS_TASK_STATUS_ACTIVE) {
+        fail("running task isn't active", running);
+    }
+    for (os_task_t *iter = osg.runqueue; iter != NULL; iter = iter->nrp) {
+        if (iter != running && os_task_status_is_running(iter->status) && iter->priority > running->priority) {
+            fail("higher priority task is ready but not running", iter);
+        }
+    }
+}
+
+/**
+ * Every task is where its status says, exactly once, and the runqueue is
+ * in priority order.
+ */
+void Harness::check_lists() {
+    size_t seen[SCHEDFUZZ_WORKERS_MAX + 1] = { 0 };
+
+    size_t length = 0;
+    os_task_t *previous = NULL;
+    for (os_task_t *iter = osg.runqueue; iter != NULL; iter = iter->nrp) {
+        if (++length > nworkers_ + 1) {
+            fail("runqueue has a cycle", NULL);
+        }
+        if (!os_task_status_is_running(iter->status)) {
+            fail("runqueue has a task that can't run", iter);
+        }
+        if (previous != NULL && previous->priority < iter->priority) {
+            fail("runqueue is out of priority order", iter);
+        }
+        seen[iter - tasks_]++;
+        previous = iter;
+    }
+
+    length = 0;
+    previous = NULL;
+    for (os_task_t *iter = osg.waitqueue; iter != NULL; iter = iter->nrp) {
+        if (++length > nworkers_ + 1) {
+            fail("waitqueue has a cycle", NULL);
+        }
+        if (iter->status != OS_TASK_STATUS_WAIT) {
+            fail("waitqueue has a task that isn't waiting", iter);
+        }
+        if (previous != NULL && previous->delay > iter->delay) {
+            fail("waitqueue is out of order", iter);
+        }
+        seen[iter - tasks_]++;
+        previous = iter;
+    }
+
+    for (size_t i = 0; i <= nworkers_; ++i) {
+        os_task_t *task = &tasks_[i];
+        bool listed = os_task_status_is_running(task->status) || task->status == OS_TASK_STATUS_WAIT;
+        if (seen[i] > 1) {
+            fail("task is on two lists", task);
+        }
+        if (listed && seen[i] == 0) {
+            fail("task is missing from its list", task);
+        }
+        if (!listed && seen[i] != 0) {
+            fail("stopped task is on a list", task);
+        }
+    }
+
+    if (osg.scheduled != NULL) {
+        fail("switch left pending", (os_task_t *)osg.scheduled);
+    }
+}
+
+/**
+ * Tasks on a blocked list are waiting on that object, and tasks waiting on
+ * an object are on its blocked list.
+ */
+void Harness::check_blocked() {
+    size_t blocked[SCHEDFUZZ_WORKERS_MAX + 1] = { 0 };
+
+    struct {
+        os_blocked_t *list;
+        uint32_t flag;
+    } lists[] = {
+        { &((os_queue_t *)queue_storage_)->blocked, OS_TASK_FLAG_QUEUE },
+        { &mutex_.blocked, OS_TASK_FLAG_MUTEX },
+        { &semaphore_.blocked, OS_TASK_FLAG_SEMAPHORE },
+        { &rwlock_.blocked, OS_TASK_FLAG_RWLOCK },
+    };
+
+    for (auto &l : lists) {
+        size_t length = 0;
+        for (os_task_t *iter = l.list->tasks; iter != NULL; iter = iter->nblocked) {
+            if (++length > nworkers_ + 1) {
+                fail("blocked list has a cycle", NULL);
+            }
+            // Tasks that time out stay on the list until they're dispatched.
+            if (iter->status != OS_TASK_STATUS_WAIT && !os_task_status_is_running(iter->status)) {
+                fail("blocked task isn't waiting", iter);
+            }
+            if ((iter->flags & l.flag) == 0) {
+                fail("blocked task doesn't know what it's waiting on", iter);
+            }
+            blocked[iter - tasks_]++;
+        }
+    }
+
+    for (size_t i = 0; i <= nworkers_; ++i) {
+        os_task_t *task = &tasks_[i];
+        if (blocked[i] > 1) {
+            fail("task is blocked on two objects", task);
+        }
+        bool waiting = (task->flags & (OS_TASK_FLAG_QUEUE | OS_TASK_FLAG_MUTEX | OS_TASK_FLAG_SEMAPHORE | OS_TASK_FLAG_RWLOCK)) != 0;
+        if (waiting && task->status == OS_TASK_STATUS_WAIT && blocked[i] == 0) {
+            fail("waiting task is on no blocked list", task);
+        }
+    }
+
+    if (mutex_.level > 0) {
+        os_task_t *owner = mutex_.owner;
+        bool alive = owner != NULL && (os_task_status_is_running(owner->status) || owner->status == OS_TASK_STATUS_WAIT ||
+                                       owner->status == OS_TASK_STATUS_SUSPENDED);
+        if (!alive) {
+            fail("mutex owned by a task that's gone", owner);
+        }
+    }
+    if (mutex_.level == 0 && mutex_.blocked.tasks != NULL) {
+        fail("free mutex has waiters", mutex_.blocked.tasks);
+    }
+    if (semaphore_.tokens > 0 && semaphore_.blocked.tasks != NULL) {
+        fail("semaphore has tokens and waiters", semaphore_.blocked.tasks);
+    }
+}
+
+void Harness::fail(const char *invariant, os_task_t *task) {
+    for (auto &entry : log_) {
+        fprintf(stderr, "%s\n", entry.c_str());
+    }
+    fprintf(stderr, "invariant: %s (%s)\n", invariant, task != NULL ? task->name : "-");
+    for (size_t i = 0; i <= nworkers_; ++i) {
+        os_task_t *iter = &tasks_[i];
+        fprintf(stderr, "%-10s status=%d priority=%d delay=%u flags=%x\n", iter->name, iter->status, iter->priority, iter->delay,
+                iter->flags);
+    }
+    abort();
+}
+
+int schedfuzz_run(const uint8_t *data, size_t size, bool verbose) {
+    Input input(data, size);
+    Harness harness(input, verbose);
+    harness.run();
+    return 0;
+}
+
+extern "C" {
+
+void osi_assert(const char *assertion, const char *file, int line) {
+    fprintf(stderr, "assertion \"%s\" failed: file \"%s\", line %d\n", assertion, file, line);
+    abort();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    return schedfuzz_run(data, size, false);
+}
+}
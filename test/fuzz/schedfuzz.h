@@ -0,0 +1,26 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_FUZZ_SCHEDFUZZ_H
+#define OS_FUZZ_SCHEDFUZZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Runs one input through the kernel, aborting with the operations so far
+ * and the broken invariant if anything goes wrong.
+ */
+int schedfuzz_run(const uint8_t *data, size_t size, bool verbose);
+
+#endif // OS_FUZZ_SCHEDFUZZ_H
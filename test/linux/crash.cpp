@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+class CrashSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+
+    std::string path;
+};
+
+void CrashSuite::SetUp() {
+    tests_platform_time(0);
+    path = tests_crash_file_setup("crash");
+}
+
+void CrashSuite::TearDown() {
+    tests_crash_file_teardown(path);
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+TEST_F(CrashSuite, Panic_TasksLocksAndEvents) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "mutex" };
+    ASSERT_EQ(osi_mutex_create(&mutex, &def), OSS_SUCCESS);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[2]);
+
+    tests_platform_time(42);
+    osi_crash_capture(OS_PANIC_APP, NULL, 0, NULL);
+
+    os_crash_snapshot_t *snapshot = os_crash_snapshot();
+    ASSERT_NE(snapshot, nullptr);
+    ASSERT_EQ(snapshot->kind, (uint32_t)OS_PANIC_APP);
+    ASSERT_EQ(snapshot->uptime, 42u);
+    ASSERT_STREQ(snapshot->running, "task-2");
+    ASSERT_EQ(snapshot->ntasks, 3);
+    ASSERT_EQ(snapshot->nlocks, 1);
+    ASSERT_STREQ(snapshot->locks[0].owner, "task-1");
+    ASSERT_GT(snapshot->nevents, 0);
+    ASSERT_EQ(snapshot->events[snapshot->nevents - 1].event, (uint32_t)OS_TRACE_EVENT_TASK_START_EXEC);
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    ASSERT_NE(contents.str().find("crash: OS_PANIC_APP at 42 ms in 'task-2'"), std::string::npos);
+    ASSERT_NE(contents.str().find("mutex 'mutex' held by 'task-1'"), std::string::npos);
+
+    ASSERT_EQ(os_crash_dump(snapshot), OSS_SUCCESS);
+}
+
+TEST_F(CrashSuite, HardFault_Registers) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    uintptr_t frame[8] = { 0 };
+    cortex_hard_fault_t hfr;
+    memset(&hfr, 0, sizeof(hfr));
+    hfr.registers.PC = (void *)0x1234;
+    hfr.registers.LR = (void *)0x5678;
+    hfr.hfsr.byte = 0x40000000;
+
+    osi_crash_capture(OS_CRASH_HARD_FAULT, frame, 0xfffffffd, &hfr);
+
+    os_crash_snapshot_t *snapshot = os_crash_snapshot();
+    ASSERT_NE(snapshot, nullptr);
+    ASSERT_EQ(snapshot->fault.pc, 0x1234u);
+    ASSERT_EQ(snapshot->fault.hfsr, 0x40000000u);
+    ASSERT_EQ(snapshot->fault.exc_return, 0xfffffffdu);
+
+    // The running task's frame comes from the fault.
+    for (uint32_t i = 0; i < snapshot->ntasks; ++i) {
+        if (strcmp(snapshot->tasks[i].name, osg.running->name) == 0) {
+            ASSERT_EQ(snapshot->tasks[i].pc, 0x1234u);
+        }
+    }
+
+    /* Corrupt RAM isn't reported. */
+    snapshot->uptime++;
+    ASSERT_EQ(os_crash_snapshot(), nullptr);
+}
+
+TEST_F(CrashSuite, Panic_CopiesNames) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "a-mutex-with-a-long-name" };
+    ASSERT_EQ(osi_mutex_create(&mutex, &def), OSS_SUCCESS);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+
+    /* The kernel records the snapshot before handing over to the hook. */
+    osi_crash(OS_PANIC_APP);
+
+    os_crash_snapshot_t *snapshot = os_crash_snapshot();
+    ASSERT_NE(snapshot, nullptr);
+    ASSERT_EQ(snapshot->kind, (uint32_t)OS_PANIC_APP);
+    ASSERT_STREQ(snapshot->locks[0].name, "a-mutex-with-a-");
+
+    /* Nothing points back into the image that crashed. */
+    tasks[1].name = "renamed";
+    ASSERT_STREQ(snapshot->running, "task-1");
+    ASSERT_STREQ(snapshot->locks[0].owner, "task-1");
+}
+
+TEST_F(CrashSuite, DebugDump_DoesNotCapture) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    osi_debug_dump(OS_PANIC_ASSERTION);
+
+    ASSERT_EQ(os_crash_snapshot(), nullptr);
+}
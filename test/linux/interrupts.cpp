@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+class InterruptsSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void InterruptsSuite::SetUp() {
+    tests_platform_time(0);
+}
+
+void InterruptsSuite::TearDown() {
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+TEST_F(InterruptsSuite, FourTasks_SemaphoreReleaseIsr_OneSwitch) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_semaphore_t semaphore;
+    os_semaphore_definition_t def = { "semaphore", 0, 0 };
+    ASSERT_EQ(osi_semaphore_create(&semaphore, &def), OSS_SUCCESS);
+
+    osi_task_set_stacked_return(&tasks[1], OSS_ERROR_TO);
+    ASSERT_EQ(osi_semaphore_acquire(&semaphore, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_semaphore_acquire(&semaphore, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[3]);
+
+    /* Two gives in the same IRQ, neither switches right away. */
+    ASSERT_EQ(osi_semaphore_release_isr(&semaphore), OSS_SUCCESS);
+    ASSERT_EQ(osi_semaphore_release_isr(&semaphore), OSS_SUCCESS);
+    ASSERT_EQ(osg.scheduled, nullptr);
+    ASSERT_EQ(osg.deferred, &tasks[1]);
+    ASSERT_EQ(tasks[1].status, OS_TASK_STATUS_IDLE);
+    ASSERT_EQ(tasks[2].status, OS_TASK_STATUS_IDLE);
+    ASSERT_EQ(semaphore.blocked.tasks, nullptr);
+    ASSERT_EQ(semaphore.tokens, 0);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[1]), OSS_SUCCESS);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[2]), OSS_SUCCESS);
+
+    /* PendSV does the one switch. */
+    osi_pendsv();
+    ASSERT_EQ(osg.deferred, nullptr);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+    ASSERT_EQ(tasks[1].semaphore, nullptr);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    ASSERT_EQ(tasks[2].semaphore, nullptr);
+}
+
+TEST_F(InterruptsSuite, FourTasks_SemaphoreReleaseIsr_HighestPriorityWins) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_semaphore_t semaphore;
+    os_semaphore_definition_t def = { "semaphore", 0, 0 };
+    ASSERT_EQ(osi_semaphore_create(&semaphore, &def), OSS_SUCCESS);
+
+    osi_task_set_stacked_return(&tasks[1], OSS_ERROR_TO);
+    ASSERT_EQ(osi_semaphore_acquire(&semaphore, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_semaphore_acquire(&semaphore, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[3]);
+
+    // Safe because task-2 is waiting and will be resorted when it wakes.
+    tasks[2].priority += 0x10;
+
+    ASSERT_EQ(osi_semaphore_release_isr(&semaphore), OSS_SUCCESS);
+    ASSERT_EQ(osi_semaphore_release_isr(&semaphore), OSS_SUCCESS);
+    ASSERT_EQ(osg.deferred, &tasks[2]);
+
+    osi_pendsv();
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+}
+
+TEST_F(InterruptsSuite, ThreeTasks_QueueDequeueIsr_WakesSender) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+    const char *messages[2] = { "message-0", "message-1" };
+
+    three_tasks_setup(tasks, stacks);
+
+    os_queue_define(queue, 1, OS_QUEUE_FLAGS_NONE);
+    ASSERT_EQ(os_queue_create(os_queue(queue), os_queue_def(queue)), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_queue_enqueue(os_queue(queue), (void *)messages[0], 500), OSS_SUCCESS);
+
+    osi_task_set_stacked_return(&tasks[1], OSS_ERROR_TO);
+    ASSERT_EQ(osi_queue_enqueue(os_queue(queue), (void *)messages[1], 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+
+    os_tuple_t tuple = osi_queue_dequeue_isr(os_queue(queue));
+    ASSERT_EQ(tuple.status, OSS_SUCCESS);
+    ASSERT_EQ(tuple.value.ptr, messages[0]);
+    ASSERT_EQ(os_queue(queue)->number, 1);
+    ASSERT_EQ(osg.deferred, &tasks[1]);
+
+    osi_pendsv();
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+    ASSERT_EQ(osi_task_stacked_return_tuple(&tasks[1])->status, OSS_SUCCESS);
+
+    tuple = osi_queue_dequeue_isr(os_queue(queue));
+    ASSERT_EQ(tuple.status, OSS_SUCCESS);
+    ASSERT_EQ(tuple.value.ptr, messages[1]);
+
+    tuple = osi_queue_dequeue_isr(os_queue(queue));
+    ASSERT_EQ(tuple.status, OSS_ERROR_MEM);
+}
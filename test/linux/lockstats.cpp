@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+class LockStatsSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void LockStatsSuite::SetUp() {
+    tests_platform_time(0);
+}
+
+void LockStatsSuite::TearDown() {
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+TEST_F(LockStatsSuite, Mutex_ContendedWaitAndHold) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "mutex" };
+    ASSERT_EQ(osi_mutex_create(&mutex, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+
+    tests_platform_time(10);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+
+    tests_platform_time(20);
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    tests_platform_time(50);
+    ASSERT_EQ(osi_mutex_release(&mutex), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+
+    tests_platform_time(55);
+    ASSERT_EQ(osi_mutex_release(&mutex), OSS_SUCCESS);
+
+    ASSERT_EQ(mutex.stats.acquisitions, 2u);
+    ASSERT_EQ(mutex.stats.contended, 1u);
+    ASSERT_EQ(mutex.stats.timeouts, 0u);
+    ASSERT_EQ(mutex.stats.wait_total, 30000u);
+    ASSERT_EQ(mutex.stats.wait_max, 30000u);
+    ASSERT_EQ(mutex.stats.hold_total, 45000u);
+    ASSERT_EQ(mutex.stats.hold_max, 40000u);
+    ASSERT_EQ(mutex.stats.worst_owner, &tasks[1]);
+}
+
+TEST_F(LockStatsSuite, Mutex_TimeOut) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "mutex" };
+    ASSERT_EQ(osi_mutex_create(&mutex, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    tests_platform_time(500);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+
+    ASSERT_EQ(mutex.stats.acquisitions, 1u);
+    ASSERT_EQ(mutex.stats.contended, 1u);
+    ASSERT_EQ(mutex.stats.timeouts, 1u);
+    ASSERT_EQ(mutex.stats.wait_max, 500000u);
+}
+
+TEST_F(LockStatsSuite, Mutex_SuspendedWhileWaiting_NotATimeOut) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "mutex" };
+    ASSERT_EQ(osi_mutex_create(&mutex, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    // Made runnable by something other than the deadline, then suspended.
+    tests_platform_time(100);
+    osi_task_status_set(&tasks[2], OS_TASK_STATUS_IDLE);
+    ASSERT_EQ(os_task_suspend(&tasks[2]), OSS_SUCCESS);
+
+    ASSERT_EQ(mutex.stats.contended, 1u);
+    ASSERT_EQ(mutex.stats.timeouts, 0u);
+}
+
+TEST_F(LockStatsSuite, Iterate_EveryKind) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t mutex_def = { "mutex" };
+    ASSERT_EQ(osi_mutex_create(&mutex, &mutex_def), OSS_SUCCESS);
+
+    os_semaphore_t semaphore;
+    os_semaphore_definition_t semaphore_def = { "semaphore", 1 };
+    ASSERT_EQ(osi_semaphore_create(&semaphore, &semaphore_def), OSS_SUCCESS);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t rwlock_def = { "rwlock" };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &rwlock_def), OSS_SUCCESS);
+
+    // Creating again doesn't list it twice.
+    ASSERT_EQ(osi_mutex_create(&mutex, &mutex_def), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    ASSERT_EQ(osi_semaphore_acquire(&semaphore, 0), OSS_SUCCESS);
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 0), OSS_SUCCESS);
+    tests_platform_time(3);
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+
+    uint32_t seen = 0;
+    for (os_lock_stats_t *iter = os_lock_stats_iterate(NULL); iter != NULL; iter = os_lock_stats_iterate(iter)) {
+        seen |= 1 << iter->kind;
+        ASSERT_EQ(iter->acquisitions, iter->kind == OS_LOCK_KIND_MUTEX ? 0u : 1u);
+    }
+    ASSERT_EQ(seen, 7u);
+    ASSERT_EQ(rwlock.stats.hold_max, 3000u);
+    ASSERT_EQ(rwlock.stats.worst_owner, &tasks[2]);
+
+    ASSERT_EQ(os_lock_stats_dump(), OSS_SUCCESS);
+    ASSERT_EQ(os_lock_stats_reset(), OSS_SUCCESS);
+    ASSERT_EQ(semaphore.stats.acquisitions, 0u);
+}
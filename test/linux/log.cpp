@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+class LogSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void LogSuite::SetUp() {
+    ASSERT_EQ(os_log_initialize(), OSS_SUCCESS);
+}
+
+void LogSuite::TearDown() {
+}
+
+TEST_F(LogSuite, NoArguments) {
+    os_log("hello");
+
+    uint32_t record[4] = { 0 };
+    ASSERT_EQ(tests_log_read(record, sizeof(record)), sizeof(uint32_t) * 2);
+    ASSERT_NE(record[0], 0u);
+    ASSERT_EQ(os_log_dropped(), 0u);
+}
+
+TEST_F(LogSuite, Arguments) {
+    os_log("%d %x %u", -1, 0xcafe, 42);
+
+    uint32_t record[8] = { 0 };
+    ASSERT_EQ(tests_log_read(record, sizeof(record)), sizeof(uint32_t) * 5);
+    ASSERT_EQ(record[2], 0xffffffffu);
+    ASSERT_EQ(record[3], 0xcafeu);
+    ASSERT_EQ(record[4], 42u);
+}
+
+TEST_F(LogSuite, SameCallSiteSameId) {
+    for (auto i = 0; i < 2; ++i) {
+        os_log("loop %d", i);
+    }
+
+    uint32_t record[6] = { 0 };
+    ASSERT_EQ(tests_log_read(record, sizeof(record)), sizeof(uint32_t) * 6);
+    ASSERT_EQ(record[0], record[3]);
+    ASSERT_EQ(record[2], 0u);
+    ASSERT_EQ(record[5], 1u);
+}
+
+TEST_F(LogSuite, Full_Dropped) {
+    uint32_t written = 0;
+    while (os_log_dropped() == 0) {
+        os_log("%d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7, 8);
+        written++;
+    }
+
+    ASSERT_EQ(written - 1, OS_LOG_BUFFER_SIZE / (sizeof(uint32_t) * 10));
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+#include <string>
+#include <vector>
+
+#include "utilities.h"
+
+class LoggerSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void LoggerSuite::SetUp() {
+    tests_platform_time(0);
+}
+
+void LoggerSuite::TearDown() {
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+static void logger_collect(const char *message, uint32_t size, void *arg) {
+    auto messages = (std::vector<std::string> *)arg;
+    messages->push_back(std::string(message, size));
+}
+
+TEST_F(LoggerSuite, ThreeTasks_DrainedInTimestampOrder) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+    os_logger_ring_t rings[2];
+    char buffers[2][256];
+
+    three_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(os_logger_attach(&tasks[1], &rings[0], buffers[0], sizeof(buffers[0])), OSS_SUCCESS);
+    ASSERT_EQ(os_logger_attach(&tasks[2], &rings[1], buffers[1], sizeof(buffers[1])), OSS_SUCCESS);
+
+    osg.running = &tasks[1];
+    tests_platform_time(1);
+    ASSERT_EQ(os_printf("one %d\n", 1), 6u);
+    tests_platform_time(3);
+    ASSERT_EQ(os_printf("three\n"), 6u);
+
+    osg.running = &tasks[2];
+    tests_platform_time(2);
+    ASSERT_EQ(os_printf("two\n"), 4u);
+    tests_platform_time(4);
+    ASSERT_EQ(os_printf("four\n"), 5u);
+
+    std::vector<std::string> messages;
+    ASSERT_EQ(os_logger_drain(logger_collect, &messages), 4u);
+    ASSERT_EQ(messages.size(), 4u);
+    ASSERT_EQ(messages[0], "one 1\n");
+    ASSERT_EQ(messages[1], "two\n");
+    ASSERT_EQ(messages[2], "three\n");
+    ASSERT_EQ(messages[3], "four\n");
+
+    ASSERT_EQ(os_logger_drain(logger_collect, &messages), 0u);
+}
+
+TEST_F(LoggerSuite, TwoTasks_Full_DroppedReported) {
+    os_task_t tasks[2];
+    uint32_t stacks[2][OS_STACK_MINIMUM_SIZE_WORDS];
+    os_logger_ring_t ring;
+    char buffer[128];
+
+    two_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(os_logger_attach(&tasks[1], &ring, buffer, 100), OSS_ERROR_INVALID);
+    ASSERT_EQ(os_logger_attach(&tasks[1], &ring, buffer, sizeof(buffer)), OSS_SUCCESS);
+
+    osg.running = &tasks[1];
+    for (auto i = 0; i < 10; ++i) {
+        os_printf("message number %d\n", i);
+    }
+
+    ASSERT_GT(os_logger_dropped(), 0u);
+    uint32_t dropped = os_logger_dropped();
+
+    std::vector<std::string> messages;
+    ASSERT_EQ(os_logger_drain(logger_collect, &messages), 10u - dropped);
+    ASSERT_EQ(messages[0], "task-1: " + std::to_string(dropped) + " messages dropped\n");
+    ASSERT_EQ(messages[1], "message number 0\n");
+
+    /* Wrap around the ring. */
+    for (auto i = 0; i < 20; ++i) {
+        os_printf("again %d\n", i);
+        messages.clear();
+        ASSERT_EQ(os_logger_drain(logger_collect, &messages), 1u);
+        ASSERT_EQ(messages[0], "again " + std::to_string(i) + "\n");
+    }
+}
+
+TEST_F(LoggerSuite, LongTaskName_DroppedNoticeTruncated) {
+    os_task_t tasks[2];
+    uint32_t stacks[2][OS_STACK_MINIMUM_SIZE_WORDS];
+    os_logger_ring_t ring;
+    char buffer[128];
+
+    two_tasks_setup(tasks, stacks);
+    tasks[1].name = "a-task-with-a-name-far-too-long-for-the-notice";
+
+    ASSERT_EQ(os_logger_attach(&tasks[1], &ring, buffer, sizeof(buffer)), OSS_SUCCESS);
+
+    osg.running = &tasks[1];
+    for (auto i = 0; i < 10; ++i) {
+        os_printf("message number %d\n", i);
+    }
+    ASSERT_GT(os_logger_dropped(), 0u);
+
+    std::vector<std::string> messages;
+    os_logger_drain(logger_collect, &messages);
+    ASSERT_EQ(messages[0].size(), 47u);
+    ASSERT_EQ(messages[0], std::string(tasks[1].name) + ":");
+}
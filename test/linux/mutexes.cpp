@@ -221,3 +221,92 @@ TEST_F(MutexesSuite, ThreeTasks_HigherPriorityTaskBlockedAcquiring) {
 
     // TODO: DEADLOCK
 }
+
+TEST_F(MutexesSuite, ThreeTasks_OwnerAborts_WaiterGetsOwnerDied) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "mutex" };
+    ASSERT_EQ(osi_mutex_create(&mutex, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osg.running, &tasks[1]);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[2]);
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 5000), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[0]);
+
+    tests_platform_time(1000);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+    svc_abort(0);
+
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[2]), OSS_ERROR_OWNER_DIED);
+    ASSERT_EQ(mutex.owner, &tasks[2]);
+    ASSERT_EQ(mutex.level, 1);
+    ASSERT_EQ(tasks[2].mutex, nullptr);
+
+    // Once repaired it's an ordinary mutex again.
+    ASSERT_EQ(osi_mutex_release(&mutex), OSS_SUCCESS);
+    ASSERT_EQ(mutex.owner, nullptr);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+}
+
+TEST_F(MutexesSuite, ThreeTasks_OwnerFinishes_NextAcquireGetsOwnerDied) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "mutex" };
+    ASSERT_EQ(osi_mutex_create(&mutex, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osg.running, &tasks[1]);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+
+    // What task_finished does when the handler returns.
+    svc_finish();
+    ASSERT_EQ(tasks[1].status, OS_TASK_STATUS_FINISHED);
+    ASSERT_EQ(mutex.owner, nullptr);
+    ASSERT_EQ(mutex.level, 0);
+
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 0), OSS_ERROR_OWNER_DIED);
+    ASSERT_EQ(mutex.owner, &tasks[2]);
+    ASSERT_EQ(osi_mutex_release(&mutex), OSS_SUCCESS);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 0), OSS_SUCCESS);
+}
+
+TEST_F(MutexesSuite, Registry_EveryKind) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t mutex_def = { "mutex" };
+    ASSERT_EQ(os_mutex_create(&mutex, &mutex_def), OSS_SUCCESS);
+
+    os_semaphore_t semaphore;
+    os_semaphore_definition_t semaphore_def = { "semaphore", 1 };
+    ASSERT_EQ(os_semaphore_create(&semaphore, &semaphore_def), OSS_SUCCESS);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t rwlock_def = { "rwlock" };
+    ASSERT_EQ(os_rwlock_create(&rwlock, &rwlock_def), OSS_SUCCESS);
+
+    ASSERT_EQ(os_mutex_iterate(NULL), &mutex);
+    ASSERT_EQ(os_mutex_iterate(&mutex), nullptr);
+    ASSERT_EQ(os_semaphore_iterate(NULL), &semaphore);
+    ASSERT_EQ(os_semaphore_iterate(&semaphore), nullptr);
+    ASSERT_EQ(os_rwlock_iterate(NULL), &rwlock);
+    ASSERT_EQ(os_rwlock_iterate(&rwlock), nullptr);
+
+    ASSERT_EQ(os_objects_dump(), OSS_SUCCESS);
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <print.h>
+#include <string>
+
+#include "utilities.h"
+
+class PrintSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void PrintSuite::SetUp() {
+}
+
+void PrintSuite::TearDown() {
+}
+
+static_assert(os::detail::placeholders("none") == 0, "");
+static_assert(os::detail::placeholders("{} and {:08x}") == 2, "");
+static_assert(os::detail::placeholders("{{}} {}") == 1, "");
+static_assert(os::detail::placeholders("{:q}") == os::detail::invalid, "");
+static_assert(os::detail::placeholders("{") == os::detail::invalid, "");
+static_assert(os::detail::placeholders("}") == os::detail::invalid, "");
+
+static_assert(os::detail::kind_of_placeholder("{} {{}} {:08x} {:s}", 0) == 0, "");
+static_assert(os::detail::kind_of_placeholder("{} {{}} {:08x} {:s}", 1) == 'x', "");
+static_assert(os::detail::kind_of_placeholder("{} {{}} {:08x} {:s}", 2) == 's', "");
+static_assert(os::detail::accepts<const char *>('s'), "");
+static_assert(!os::detail::accepts<const char *>('x'), "");
+static_assert(!os::detail::accepts<int>('s'), "");
+static_assert(!os::detail::accepts<bool>('d'), "");
+static_assert(decltype(os::detail::types(1, "a"))::accepted("{:x} {:s}", 0), "");
+static_assert(!decltype(os::detail::types(1, "a"))::accepted("{:s} {:x}", 0), "");
+
+TEST_F(PrintSuite, Format_Integers) {
+    char buffer[64];
+
+    ASSERT_EQ(OS_FORMAT(buffer, sizeof(buffer), "{} {} {}", 42, -7, 3000000000u), 16u);
+    ASSERT_STREQ(buffer, "42 -7 3000000000");
+
+    OS_FORMAT(buffer, sizeof(buffer), "{:x} {:08X} {:b} {:5d}|{:05d}", 0xbeef, 0xcafe, 5, -12, -12);
+    ASSERT_STREQ(buffer, "beef 0000CAFE 101   -12|-0012");
+
+    OS_FORMAT(buffer, sizeof(buffer), "{} {}", (uint8_t)200, (int64_t)-9000000000LL);
+    ASSERT_STREQ(buffer, "200 -9000000000");
+}
+
+TEST_F(PrintSuite, Format_Others) {
+    char buffer[64];
+    const char *name = "task";
+
+    OS_FORMAT(buffer, sizeof(buffer), "{} {:6} {} {} {{x}}", name, "ab", 'z', true);
+    ASSERT_STREQ(buffer, "task     ab z true {x}");
+
+    OS_FORMAT(buffer, sizeof(buffer), "{}", OSS_ERROR_INVALID);
+    ASSERT_EQ(std::string(buffer), std::to_string((int)OSS_ERROR_INVALID));
+
+    OS_FORMAT(buffer, sizeof(buffer), "no placeholders");
+    ASSERT_STREQ(buffer, "no placeholders");
+}
+
+TEST_F(PrintSuite, Format_Truncated) {
+    char buffer[8];
+
+    ASSERT_EQ(OS_FORMAT(buffer, sizeof(buffer), "{}-{}", 123456, 789), 10u);
+    ASSERT_STREQ(buffer, "123456-");
+}
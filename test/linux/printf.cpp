@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <string>
+#include <vector>
+
+#include "utilities.h"
+
+class PrintfSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void PrintfSuite::SetUp() {
+}
+
+void PrintfSuite::TearDown() {
+}
+
+static void chunk_collect(const char *chunk, size_t size, void *arg) {
+    auto chunks = (std::vector<std::string> *)arg;
+    chunks->push_back(std::string(chunk, size));
+}
+
+static int chunk_printf(std::vector<std::string> &chunks, size_t size, const char *f, ...) {
+    char buffer[64];
+    va_list args;
+    va_start(args, f);
+    auto i = os_vchunkprintf(chunk_collect, &chunks, buffer, size, f, args);
+    va_end(args);
+    return i;
+}
+
+TEST_F(PrintfSuite, Chunked_Short) {
+    std::vector<std::string> chunks;
+
+    ASSERT_EQ(chunk_printf(chunks, 64, "hello %d", 42), 8);
+    ASSERT_EQ(chunks.size(), 1u);
+    ASSERT_EQ(chunks[0], "hello 42");
+}
+
+TEST_F(PrintfSuite, Chunked_SplitsWhenFull) {
+    std::vector<std::string> chunks;
+
+    ASSERT_EQ(chunk_printf(chunks, 4, "%s-%04x", "abcdef", 0xbeef), 11);
+    ASSERT_EQ(chunks.size(), 3u);
+    ASSERT_EQ(chunks[0], "abcd");
+    ASSERT_EQ(chunks[1], "ef-b");
+    ASSERT_EQ(chunks[2], "eef");
+}
+
+TEST_F(PrintfSuite, Chunked_ExactlyFull_NoEmptyChunk) {
+    std::vector<std::string> chunks;
+
+    ASSERT_EQ(chunk_printf(chunks, 4, "abcd"), 4);
+    ASSERT_EQ(chunks.size(), 1u);
+    ASSERT_EQ(chunks[0], "abcd");
+}
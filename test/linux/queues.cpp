@@ -299,3 +299,72 @@ TEST_F(QueuesSuite, ThreeTasks_Queue_ReceiveBlockTimeOut) {
     // ASSERT_EQ(tuple->status, OSS_ERROR_TO);
     // ASSERT_EQ(tuple->value.ptr, nullptr);
 }
+
+TEST_F(QueuesSuite, ThreeTasks_Queue_Stats) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+    const char *messages[3] = { "message-0", "message-1", "message-2" };
+
+    three_tasks_setup(tasks, stacks);
+
+    os_queue_define(queue, 2, OS_QUEUE_FLAGS_NONE);
+
+    ASSERT_EQ(os_queue_create(os_queue(queue), os_queue_def(queue)), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_queue_enqueue(os_queue(queue), (void *)messages[0], 500), OSS_SUCCESS);
+    tests_platform_time(10);
+    ASSERT_EQ(osi_queue_enqueue(os_queue(queue), (void *)messages[1], 500), OSS_SUCCESS);
+
+    /* Full, so task-1 blocks and then times out. */
+    osi_task_set_stacked_return(&tasks[1], OSS_ERROR_TO);
+    ASSERT_EQ(osi_queue_enqueue(os_queue(queue), (void *)messages[2], 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+    tests_platform_time(510);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+
+    tests_platform_time(530);
+    void *received = nullptr;
+    ASSERT_EQ(osi_queue_dequeue(os_queue(queue), &received, 500), OSS_SUCCESS);
+    ASSERT_EQ(received, messages[0]);
+    ASSERT_EQ(osi_queue_dequeue(os_queue(queue), &received, 500), OSS_SUCCESS);
+    ASSERT_EQ(received, messages[1]);
+
+    os_queue_stats_t stats;
+    ASSERT_EQ(os_queue_stats_get(os_queue(queue), &stats), OSS_SUCCESS);
+    ASSERT_EQ(stats.enqueued, 2u);
+    ASSERT_EQ(stats.dequeued, 2u);
+    ASSERT_EQ(stats.highwater, 2u);
+    ASSERT_EQ(stats.full_blocks, 1u);
+    ASSERT_EQ(stats.empty_blocks, 0u);
+    ASSERT_EQ(stats.timeouts, 1u);
+    ASSERT_EQ(stats.latency_max, 530000u);
+    ASSERT_EQ(stats.latency_total, 530000u + 520000u);
+
+    ASSERT_EQ(os_queue_stats_reset(os_queue(queue)), OSS_SUCCESS);
+    ASSERT_EQ(os_queue_stats_get(os_queue(queue), &stats), OSS_SUCCESS);
+    ASSERT_EQ(stats.enqueued, 0u);
+    ASSERT_EQ(stats.highwater, 0u);
+}
+
+TEST_F(QueuesSuite, Queue_Registry) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_queue_define(first, 2, OS_QUEUE_FLAGS_NONE);
+    os_queue_define(second, 2, OS_QUEUE_FLAGS_NONE);
+
+    ASSERT_EQ(os_queue_iterate(NULL), nullptr);
+
+    ASSERT_EQ(os_queue_create(os_queue(first), os_queue_def(first)), OSS_SUCCESS);
+    ASSERT_EQ(os_queue_create(os_queue(second), os_queue_def(second)), OSS_SUCCESS);
+    ASSERT_EQ(os_queue_create(os_queue(first), os_queue_def(first)), OSS_SUCCESS);
+
+    os_queue_t *iter = os_queue_iterate(NULL);
+    ASSERT_EQ(iter, os_queue(second));
+    ASSERT_STREQ(iter->def->name, "second");
+    iter = os_queue_iterate(iter);
+    ASSERT_EQ(iter, os_queue(first));
+    ASSERT_EQ(os_queue_iterate(iter), nullptr);
+}
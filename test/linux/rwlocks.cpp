@@ -0,0 +1,350 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+class RwLocksSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void RwLocksSuite::SetUp() {
+    tests_platform_time(0);
+}
+
+void RwLocksSuite::TearDown() {
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+TEST_F(RwLocksSuite, FourTasks_PreferReaders_ReaderJoinsWhileWriterWaits) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PREFER_READERS };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+
+    /* task-2 wants to write and has to wait for task-1. */
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(rwlock.blocked.tasks, &tasks[2]);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    /* task-3 is let in even though a writer is waiting. */
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[3]);
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.readers, 2);
+    ASSERT_EQ(rwlock.blocked.tasks, &tasks[2]);
+}
+
+TEST_F(RwLocksSuite, FourTasks_PreferReaders_WriterReleaseWakesAllReaders) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PREFER_READERS };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[3]);
+    osi_task_set_stacked_return(&tasks[3], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    /* Both readers get the lock, the first one is dispatched immediately. */
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.readers, 2);
+    ASSERT_EQ(rwlock.writers, 0);
+    ASSERT_EQ(rwlock.blocked.tasks, nullptr);
+    ASSERT_EQ(osg.scheduled, &tasks[2]);
+    ASSERT_EQ(tasks[3].status, OS_TASK_STATUS_IDLE);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[2]), OSS_SUCCESS);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[3]), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+}
+
+TEST_F(RwLocksSuite, FourTasks_PreferWriters_ReaderWaitsForWriter) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PREFER_WRITERS };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    /* task-3 queues up behind the waiting writer. */
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[3]);
+    osi_task_set_stacked_return(&tasks[3], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(rwlock.readers, 1);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    /* task-1 releases and the writer goes first. */
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+    ASSERT_EQ(rwlock.writer, &tasks[2]);
+    ASSERT_EQ(rwlock.writers, 1);
+    ASSERT_EQ(rwlock.readers, 0);
+    ASSERT_EQ(rwlock.blocked.tasks, &tasks[3]);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[2]), OSS_SUCCESS);
+
+    /* Then the reader. */
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[3]);
+    ASSERT_EQ(rwlock.writer, nullptr);
+    ASSERT_EQ(rwlock.readers, 1);
+    ASSERT_EQ(rwlock.blocked.tasks, nullptr);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[3]), OSS_SUCCESS);
+}
+
+TEST_F(RwLocksSuite, FourTasks_PreferWriters_WriterReleaseFavorsWriter) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PREFER_WRITERS };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[3]);
+    osi_task_set_stacked_return(&tasks[3], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[3]);
+    ASSERT_EQ(rwlock.writer, &tasks[3]);
+    ASSERT_EQ(rwlock.blocked.tasks, &tasks[2]);
+}
+
+TEST_F(RwLocksSuite, FourTasks_PhaseFair_Alternates) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PHASE_FAIR };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[3]);
+    osi_task_set_stacked_return(&tasks[3], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    /* End of the write phase, the waiting reader goes next. */
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+    ASSERT_EQ(rwlock.readers, 1);
+    ASSERT_EQ(rwlock.blocked.tasks, &tasks[3]);
+
+    /* New readers wait behind the writer. */
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+    osi_task_set_stacked_return(&tasks[1], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+
+    /* End of the read phase, the writer goes next. */
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[3]);
+    ASSERT_EQ(rwlock.writer, &tasks[3]);
+    ASSERT_EQ(rwlock.blocked.tasks, &tasks[1]);
+
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+    ASSERT_EQ(rwlock.readers, 1);
+    ASSERT_EQ(rwlock.blocked.tasks, nullptr);
+}
+
+TEST_F(RwLocksSuite, FourTasks_PreferWriters_NestedReadsDontDeadlock) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PREFER_WRITERS };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_SUCCESS);
+    ASSERT_EQ(osi_rwlock_read_depth(&rwlock, &tasks[1]), 1);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    /* task-1 reads again even though a writer is waiting. */
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.readers, 1);
+    ASSERT_EQ(osi_rwlock_read_depth(&rwlock, &tasks[1]), 2);
+
+    /* Writing while reading would deadlock. */
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_ERROR_INVALID);
+
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.readers, 1);
+    ASSERT_EQ(osg.scheduled, nullptr);
+
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(osi_rwlock_read_depth(&rwlock, &tasks[1]), 0);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+    ASSERT_EQ(rwlock.writer, &tasks[2]);
+}
+
+TEST_F(RwLocksSuite, FourTasks_PreferWriters_NestedReadsOnSecondLockDontDeadlock) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_rwlock_t first;
+    os_rwlock_definition_t first_def = { "first", OS_RWLOCK_FLAG_PREFER_WRITERS };
+    ASSERT_EQ(osi_rwlock_create(&first, &first_def), OSS_SUCCESS);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_PREFER_WRITERS };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_rwlock_acquire_read(&first, 500), OSS_SUCCESS);
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_SUCCESS);
+
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    /* The read on the second lock is tracked too. */
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_SUCCESS);
+    ASSERT_EQ(osi_rwlock_read_depth(&rwlock, &tasks[1]), 2);
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_ERROR_INVALID);
+
+    /* Every slot is taken, so a third lock can't be read. */
+    os_rwlock_t third;
+    os_rwlock_definition_t third_def = { "third", OS_RWLOCK_FLAG_NONE };
+    ASSERT_EQ(osi_rwlock_create(&third, &third_def), OSS_SUCCESS);
+    ASSERT_EQ(osi_rwlock_acquire_read(&third, 500), OSS_ERROR_INVALID);
+
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+    ASSERT_EQ(rwlock.writer, &tasks[2]);
+    ASSERT_EQ(osi_rwlock_read_depth(&first, &tasks[1]), 1);
+}
+
+TEST_F(RwLocksSuite, ThreeTasks_Upgradeable_UpgradesImmediately) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_NONE };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_rwlock_acquire_upgradeable(&rwlock, 500), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.upgrader, &tasks[1]);
+    ASSERT_EQ(rwlock.readers, 1);
+
+    ASSERT_EQ(osi_rwlock_upgrade(&rwlock, 500), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.upgrader, nullptr);
+    ASSERT_EQ(rwlock.readers, 0);
+    ASSERT_EQ(rwlock.writers, 1);
+    ASSERT_EQ(rwlock.writer, &tasks[1]);
+    ASSERT_EQ(osi_rwlock_read_depth(&rwlock, &tasks[1]), 0);
+
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.writers, 0);
+    ASSERT_EQ(rwlock.writer, nullptr);
+}
+
+TEST_F(RwLocksSuite, FourTasks_Upgradeable_UpgradeWaitsForReaders) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t def = { "rwlock", OS_RWLOCK_FLAG_NONE };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &def), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_rwlock_acquire_upgradeable(&rwlock, 500), OSS_SUCCESS);
+
+    /* Plain readers share the lock with the upgrader. */
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    ASSERT_EQ(osi_rwlock_acquire_read(&rwlock, 500), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.readers, 2);
+
+    /* Only they can't upgrade. */
+    ASSERT_EQ(osi_rwlock_upgrade(&rwlock, 500), OSS_ERROR_INVALID);
+
+    /* There's only one upgrader. */
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[3]);
+    osi_task_set_stacked_return(&tasks[3], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_acquire_upgradeable(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(rwlock.blocked.tasks, &tasks[3]);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+
+    /* task-1 waits for task-2 to finish reading. */
+    osi_task_set_stacked_return(&tasks[1], OSS_ERROR_TO);
+    ASSERT_EQ(osi_rwlock_upgrade(&rwlock, 500), OSS_ERROR_TO);
+    ASSERT_EQ(rwlock.upgrader, &tasks[1]);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[1]);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[1]), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.readers, 0);
+    ASSERT_EQ(rwlock.writer, &tasks[1]);
+    ASSERT_EQ(rwlock.upgrader, nullptr);
+    ASSERT_EQ(rwlock.blocked.tasks, &tasks[3]);
+
+    /* Finally task-3 becomes the upgrader. */
+    ASSERT_EQ(osi_rwlock_release(&rwlock), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[3]);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[3]), OSS_SUCCESS);
+    ASSERT_EQ(rwlock.upgrader, &tasks[3]);
+    ASSERT_EQ(rwlock.readers, 1);
+    ASSERT_EQ(osi_rwlock_read_depth(&rwlock, &tasks[3]), 1);
+}
@@ -244,3 +244,142 @@ TEST_F(ScheduleSuite, ThreeTasks_HigherPrioritySleeps) {
     tests_platform_time(1000);
     ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
 }
+
+TEST_F(ScheduleSuite, ThreeTasks_SchedulerLock_DefersRoundRobin) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(osg.running, &tasks[1]);
+
+    ASSERT_EQ(os_scheduler_lock(), OSS_SUCCESS);
+    ASSERT_EQ(os_scheduler_lock(), OSS_SUCCESS);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+    ASSERT_TRUE(osg.reschedule);
+
+    /* Still nested, nothing happens. */
+    ASSERT_EQ(os_scheduler_unlock(), OSS_SUCCESS);
+    ASSERT_EQ(osg.scheduled, nullptr);
+
+    ASSERT_EQ(os_scheduler_unlock(), OSS_SUCCESS);
+    ASSERT_FALSE(osg.reschedule);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+
+    ASSERT_EQ(os_scheduler_unlock(), OSS_ERROR_INVALID);
+}
+
+TEST_F(ScheduleSuite, ThreeTasks_SchedulerLock_DefersWake) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    // Safe because task-2 is the only one sleeping and will be resorted.
+    tasks[2].priority += 0x10;
+    tests_sleep_task(tasks[2]);
+
+    ASSERT_EQ(os_scheduler_lock(), OSS_SUCCESS);
+
+    ASSERT_EQ(osi_dispatch_or_queue(&tasks[2]), OSS_SUCCESS);
+    ASSERT_EQ(osg.scheduled, nullptr);
+    ASSERT_EQ(osg.deferred, &tasks[2]);
+    ASSERT_EQ(tasks[2].status, OS_TASK_STATUS_IDLE);
+
+    ASSERT_EQ(os_scheduler_unlock(), OSS_SUCCESS);
+    ASSERT_EQ(osg.deferred, nullptr);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+}
+
+TEST_F(ScheduleSuite, FiveTasks_SchedulerUnlock_OverridesPendingSwitch) {
+    os_task_t tasks[5];
+    uint32_t stacks[5][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    five_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(osg.running, &tasks[1]);
+
+    // Safe because these are the only ones sleeping and will be resorted.
+    tasks[2].priority += 0x10;
+    tasks[3].priority += 0x20;
+    tests_sleep_task(tasks[2]);
+    tests_sleep_task(tasks[3]);
+
+    ASSERT_EQ(os_scheduler_lock(), OSS_SUCCESS);
+    ASSERT_EQ(osi_dispatch_or_queue(&tasks[2]), OSS_SUCCESS);
+    ASSERT_EQ(osg.deferred, &tasks[2]);
+
+    /* The count drops and an IRQ gets in before the trap, switching to a
+     * peer and waking task-3 behind it. */
+    tasks[1].scheduler_locks = 0;
+    ASSERT_EQ(osi_dispatch(&tasks[4]), OSS_SUCCESS);
+    ASSERT_EQ(osg.scheduled, &tasks[4]);
+    ASSERT_EQ(tasks[1].status, OS_TASK_STATUS_IDLE);
+    osi_task_status_set(&tasks[3], OS_TASK_STATUS_IDLE);
+
+    ASSERT_EQ(osi_reschedule(), OSS_SUCCESS);
+    ASSERT_EQ(osg.deferred, nullptr);
+    ASSERT_EQ(tasks[4].status, OS_TASK_STATUS_IDLE);
+    ASSERT_EQ(tasks[1].status, OS_TASK_STATUS_IDLE);
+    ASSERT_EQ(tests_task_switch(), &tasks[3]);
+}
+
+TEST_F(ScheduleSuite, ThreeTasks_SchedulerLock_BlockingStillSwitches) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(os_scheduler_lock(), OSS_SUCCESS);
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[2]);
+
+    /* The lock belongs to task-1, so task-2 is preemptible. */
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[2]);
+    ASSERT_FALSE(osg.reschedule);
+    ASSERT_EQ(tasks[1].scheduler_locks, 1);
+}
+
+TEST_F(ScheduleSuite, StackScan_ConvergesAndRestartRepaints) {
+    os_task_t tasks[2];
+    uint32_t stacks[2][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    two_tasks_setup(tasks, stacks);
+
+    /* Slots in the initial frame may still look painted, so a full scan
+     * can only find more free space than we start out assuming. */
+    uint32_t initial = tasks[1].highwater;
+    uint32_t scanned = os_task_highwater(&tasks[1]);
+    ASSERT_GE(scanned, initial);
+    ASSERT_LT(scanned, OS_STACK_MINIMUM_SIZE_WORDS);
+
+    stacks[1][16] = 0;
+    stacks[1][8] = 0;
+
+    /* Plenty of small calls to get through both tasks a few times. */
+    for (uint32_t i = 0; i < OS_STACK_MINIMUM_SIZE_WORDS; ++i) {
+        os_stack_scan(4);
+    }
+
+    ASSERT_EQ(tasks[1].highwater, 8);
+    ASSERT_LE(tasks[0].highwater, initial);
+    ASSERT_EQ(os_task_highwater(&tasks[1]), 8);
+
+    ASSERT_EQ(os_task_suspend(&tasks[1]), OSS_SUCCESS);
+    ASSERT_EQ(os_task_start(&tasks[1]), OSS_SUCCESS);
+
+    ASSERT_EQ(stacks[1][8], OSH_STACK_MAGIC_WORD);
+    ASSERT_EQ(stacks[1][16], OSH_STACK_MAGIC_WORD);
+    ASSERT_EQ(tasks[1].highwater, initial);
+    ASSERT_EQ(os_task_highwater(&tasks[1]), scanned);
+
+    /* Used below the cached mark but not scanned yet, so the restart leaves
+     * it alone and it still shows up as used afterwards. */
+    stacks[1][6] = 0;
+
+    ASSERT_EQ(os_task_suspend(&tasks[1]), OSS_SUCCESS);
+    ASSERT_EQ(os_task_start(&tasks[1]), OSS_SUCCESS);
+
+    ASSERT_EQ(stacks[1][6], 0u);
+    ASSERT_EQ(os_task_highwater(&tasks[1]), 6);
+}
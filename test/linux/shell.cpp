@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+class ShellSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void ShellSuite::SetUp() {
+    tests_platform_time(0);
+}
+
+void ShellSuite::TearDown() {
+    ASSERT_EQ(os_trace_stop(), OSS_SUCCESS);
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+TEST_F(ShellSuite, Execute_Commands) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_queue_define(queue, 2, OS_QUEUE_FLAGS_NONE);
+    ASSERT_EQ(os_queue_create(os_queue(queue), os_queue_def(queue)), OSS_SUCCESS);
+
+    os_mutex_t mutex;
+    os_mutex_definition_t def = { "mutex" };
+    ASSERT_EQ(os_mutex_create(&mutex, &def), OSS_SUCCESS);
+
+    tests_platform_time(100);
+
+    ASSERT_EQ(os_shell_execute("tasks"), OSS_SUCCESS);
+    ASSERT_EQ(os_shell_execute("  queues"), OSS_SUCCESS);
+    ASSERT_EQ(os_shell_execute("locks"), OSS_SUCCESS);
+    ASSERT_EQ(os_shell_execute(""), OSS_SUCCESS);
+    ASSERT_EQ(os_shell_execute("taskss"), OSS_ERROR_INVALID);
+    ASSERT_EQ(os_shell_execute("trace sideways"), OSS_ERROR_INVALID);
+}
+
+TEST_F(ShellSuite, Poll_RunsCompleteLines) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    uint8_t byte;
+    while (tests_trace_read(&byte, 1) > 0) {
+    }
+
+    const char *partial = "trace st";
+    ASSERT_EQ(tests_shell_write(partial, strlen(partial)), strlen(partial));
+    ASSERT_EQ(os_shell_poll(), OSS_SUCCESS);
+    ASSERT_EQ(tests_trace_read(&byte, 1), 0u);
+
+    const char *rest = "art\r\n";
+    ASSERT_EQ(tests_shell_write(rest, strlen(rest)), strlen(rest));
+    ASSERT_EQ(os_shell_poll(), OSS_SUCCESS);
+    ASSERT_EQ(tests_trace_read(&byte, 1), 1u);
+}
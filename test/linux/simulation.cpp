@@ -0,0 +1,171 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <gtest/gtest.h>
+
+#include "simulator.h"
+
+class SimulationSuite : public ::testing::Test {};
+
+
+/**
+ * Rate monotonic, the shorter period gets the higher priority and both
+ * make their deadlines.
+ */
+TEST_F(SimulationSuite, TwoPeriodicTasks_RateMonotonic) {
+    Simulator sim;
+
+    auto &fast = sim.task("fast", OS_PRIORITY_NORMAL + 1, 10, 10).compute(3);
+    auto &slow = sim.task("slow", OS_PRIORITY_NORMAL, 20, 20).compute(8);
+
+    sim.run(100);
+
+    ASSERT_EQ(fast.report().jobs, 10);
+    ASSERT_EQ(fast.report().misses, 0);
+    ASSERT_EQ(fast.report().response_max, 3);
+    ASSERT_EQ(fast.report().cpu, 30);
+
+    /* fast runs 0-3, slow 3-10, fast 10-13 and slow finishes at 14. */
+    ASSERT_EQ(slow.report().jobs, 5);
+    ASSERT_EQ(slow.report().misses, 0);
+    ASSERT_EQ(slow.report().response_min, 14);
+    ASSERT_EQ(slow.report().response_max, 14);
+    ASSERT_EQ(slow.report().cpu, 40);
+
+    ASSERT_EQ(sim.idle(), 30);
+    ASSERT_DOUBLE_EQ(sim.utilization(), 0.7);
+}
+
+/**
+ * Same load with the priorities the wrong way around, the short task waits
+ * behind the long one and misses.
+ */
+TEST_F(SimulationSuite, TwoPeriodicTasks_PriorityInversionMissesDeadlines) {
+    Simulator sim;
+
+    auto &fast = sim.task("fast", OS_PRIORITY_NORMAL, 10, 10).compute(3);
+    auto &slow = sim.task("slow", OS_PRIORITY_NORMAL + 1, 20, 20).compute(8);
+
+    sim.run(100);
+
+    ASSERT_EQ(slow.report().misses, 0);
+    ASSERT_EQ(slow.report().response_max, 8);
+
+    /* Every other job is released while slow is computing. */
+    ASSERT_EQ(fast.report().jobs, 10);
+    ASSERT_EQ(fast.report().response_max, 11);
+    ASSERT_EQ(fast.report().misses, 5);
+}
+
+/**
+ * Response is measured from the interrupt, not from when the handler gets
+ * to run, and the handler preempts the background work.
+ */
+TEST_F(SimulationSuite, InterruptWakesHandler) {
+    Simulator sim;
+
+    auto irq = sim.semaphore("irq", 0);
+    auto &handler = sim.task("handler", OS_PRIORITY_NORMAL + 1, 0, 3).take(irq).compute(2);
+    auto &background = sim.task("background", OS_PRIORITY_NORMAL).compute(1000);
+    auto &timer = sim.interrupt("timer", 5, 10).give(irq);
+
+    sim.run(100);
+
+    ASSERT_EQ(timer.fired(), 10);
+    ASSERT_EQ(handler.report().jobs, 10);
+    ASSERT_EQ(handler.report().response_min, 2);
+    ASSERT_EQ(handler.report().response_max, 2);
+    ASSERT_EQ(handler.report().misses, 0);
+    ASSERT_EQ(handler.report().cpu, 20);
+    ASSERT_EQ(background.report().cpu, 80);
+    ASSERT_EQ(sim.idle(), 0);
+}
+
+/**
+ * A producer feeding a consumer through a queue, with timeouts when the
+ * consumer falls behind.
+ */
+TEST_F(SimulationSuite, ProducerConsumer_QueueBackpressure) {
+    Simulator sim;
+
+    auto queue = sim.queue("queue", 2);
+    auto &producer = sim.task("producer", OS_PRIORITY_NORMAL + 1, 5, 5).compute(1).send(queue, 42, 2);
+    auto &consumer = sim.task("consumer", OS_PRIORITY_NORMAL).receive(queue).compute(7);
+
+    sim.run(200);
+
+    /* The consumer can't keep up, so sends time out once the queue is full. */
+    ASSERT_EQ(producer.report().jobs, 40);
+    ASSERT_EQ(producer.report().misses, 0);
+    ASSERT_GT(producer.report().timeouts, 0);
+    ASSERT_EQ(consumer.report().timeouts, 0);
+
+    /* Everything sent was consumed, is queued or is being worked on. */
+    ASSERT_EQ(producer.report().jobs - producer.report().timeouts, consumer.report().jobs + 2 + 1);
+}
+
+/**
+ * Two tasks sharing a mutex, the higher priority one waits for the lower
+ * priority holder to finish.
+ */
+TEST_F(SimulationSuite, SharedMutex_BlockingShowsUpInResponse) {
+    Simulator sim;
+
+    auto mutex = sim.mutex("mutex");
+    auto &high = sim.task("high", OS_PRIORITY_NORMAL + 1, 10, 10, 1).lock(mutex).compute(1).unlock(mutex);
+    auto &low = sim.task("low", OS_PRIORITY_NORMAL, 20, 20).lock(mutex).compute(4).unlock(mutex);
+
+    sim.run(20);
+
+    /* low holds the mutex from 0 to 4, high is released at 1 and 11. */
+    ASSERT_EQ(high.report().jobs, 2);
+    ASSERT_EQ(high.report().response_max, 4);
+    ASSERT_EQ(high.report().response_min, 1);
+    ASSERT_EQ(low.report().jobs, 1);
+}
+
+static std::vector<SimulatorReport> simulate(uint32_t &idle) {
+    Simulator sim;
+
+    auto queue = sim.queue("queue", 4);
+    auto irq = sim.semaphore("irq", 0);
+    auto &a = sim.task("a", OS_PRIORITY_NORMAL + 2, 0, 5).take(irq).compute(1).send(queue, 1, 1);
+    auto &b = sim.task("b", OS_PRIORITY_NORMAL + 1, 7, 7).compute(2).receive(queue, 3);
+    auto &c = sim.task("c", OS_PRIORITY_NORMAL).compute(3).sleep(2);
+    auto &d = sim.task("d", OS_PRIORITY_NORMAL).compute(2);
+    sim.interrupt("timer", 3, 4).give(irq);
+
+    sim.run(1000);
+
+    idle = sim.idle();
+
+    return { a.report(), b.report(), c.report(), d.report() };
+}
+
+TEST_F(SimulationSuite, Deterministic) {
+    uint32_t idle[2];
+    auto first = simulate(idle[0]);
+    auto second = simulate(idle[1]);
+
+    ASSERT_EQ(idle[0], idle[1]);
+    for (size_t i = 0; i < first.size(); ++i) {
+        ASSERT_GT(first[i].jobs, 0);
+        ASSERT_EQ(first[i].jobs, second[i].jobs);
+        ASSERT_EQ(first[i].misses, second[i].misses);
+        ASSERT_EQ(first[i].timeouts, second[i].timeouts);
+        ASSERT_EQ(first[i].response_min, second[i].response_min);
+        ASSERT_EQ(first[i].response_max, second[i].response_max);
+        ASSERT_EQ(first[i].response_total, second[i].response_total);
+        ASSERT_EQ(first[i].cpu, second[i].cpu);
+    }
+}
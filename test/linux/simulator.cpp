@@ -0,0 +1,437 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+
+#include "simulator.h"
+
+static void task_handler_simulated(void *params) {
+}
+
+SimulatorTask::SimulatorTask(const char *name, os_priority_t priority, uint32_t period, uint32_t deadline, uint32_t offset)
+    : name_(name), priority_(priority), period_(period), deadline_(deadline), stack_(OS_STACK_MINIMUM_SIZE_WORDS),
+      next_release_(offset) {
+}
+
+SimulatorTask &SimulatorTask::add(SimulatorStepKind kind, uint32_t duration, void *object, uint32_t value) {
+    steps_.push_back(SimulatorStep{ kind, duration, object, value });
+    return *this;
+}
+
+SimulatorTask &SimulatorTask::compute(uint32_t ms) {
+    return add(SimulatorStepKind::Compute, ms, NULL, 0);
+}
+
+SimulatorTask &SimulatorTask::sleep(uint32_t ms) {
+    return add(SimulatorStepKind::Sleep, ms, NULL, 0);
+}
+
+SimulatorTask &SimulatorTask::send(os_queue_t *queue, uint32_t value, uint32_t to) {
+    return add(SimulatorStepKind::Send, to, queue, value);
+}
+
+SimulatorTask &SimulatorTask::receive(os_queue_t *queue, uint32_t to) {
+    return add(SimulatorStepKind::Receive, to, queue, 0);
+}
+
+SimulatorTask &SimulatorTask::take(os_semaphore_t *semaphore, uint32_t to) {
+    return add(SimulatorStepKind::Take, to, semaphore, 0);
+}
+
+SimulatorTask &SimulatorTask::give(os_semaphore_t *semaphore) {
+    return add(SimulatorStepKind::Give, 0, semaphore, 0);
+}
+
+SimulatorTask &SimulatorTask::lock(os_mutex_t *mutex, uint32_t to) {
+    return add(SimulatorStepKind::Lock, to, mutex, 0);
+}
+
+SimulatorTask &SimulatorTask::unlock(os_mutex_t *mutex) {
+    return add(SimulatorStepKind::Unlock, 0, mutex, 0);
+}
+
+SimulatorInterrupt::SimulatorInterrupt(const char *name, uint32_t first, uint32_t period) : name_(name), next_(first), period_(period) {
+}
+
+SimulatorInterrupt &SimulatorInterrupt::give(os_semaphore_t *semaphore) {
+    steps_.push_back(SimulatorStep{ SimulatorStepKind::Give, 0, semaphore, 0 });
+    return *this;
+}
+
+SimulatorInterrupt &SimulatorInterrupt::send(os_queue_t *queue, uint32_t value) {
+    steps_.push_back(SimulatorStep{ SimulatorStepKind::Send, 0, queue, value });
+    return *this;
+}
+
+Simulator::Simulator() : idle_stack_(OS_STACK_MINIMUM_SIZE_WORDS) {
+    tests_platform_time(0);
+    OS_ASSERT(os_initialize() == OSS_SUCCESS);
+}
+
+Simulator::~Simulator() {
+    os_teardown();
+}
+
+SimulatorTask &Simulator::task(const char *name, os_priority_t priority, uint32_t period, uint32_t deadline, uint32_t offset) {
+    OS_ASSERT(!started_);
+    tasks_.emplace_back(name, priority, period, deadline, offset);
+    return tasks_.back();
+}
+
+SimulatorInterrupt &Simulator::interrupt(const char *name, uint32_t first, uint32_t period) {
+    // Nothing happens at time zero but starting.
+    OS_ASSERT(first > 0);
+    interrupts_.emplace_back(name, first, period);
+    return interrupts_.back();
+}
+
+os_queue_t *Simulator::queue(const char *name, uint16_t size) {
+    names_.emplace_back(name);
+    queue_defs_.push_back(os_queue_definition_t{ names_.back().c_str(), size, OS_QUEUE_FLAGS_NONE });
+    queues_.emplace_back(os_word_size(os_queue_t) + size * OS_QUEUE_SLOT_WORDS);
+    os_queue_t *queue = (os_queue_t *)queues_.back().data();
+    OS_ASSERT(osi_queue_create(queue, &queue_defs_.back()) == OSS_SUCCESS);
+    return queue;
+}
+
+os_semaphore_t *Simulator::semaphore(const char *name, uint32_t tokens) {
+    names_.emplace_back(name);
+    semaphore_defs_.push_back(os_semaphore_definition_t{ names_.back().c_str(), tokens, 0 });
+    semaphores_.emplace_back();
+    OS_ASSERT(osi_semaphore_create(&semaphores_.back(), &semaphore_defs_.back()) == OSS_SUCCESS);
+    return &semaphores_.back();
+}
+
+os_mutex_t *Simulator::mutex(const char *name) {
+    names_.emplace_back(name);
+    mutex_defs_.push_back(os_mutex_definition_t{ names_.back().c_str(), 0 });
+    mutexes_.emplace_back();
+    OS_ASSERT(osi_mutex_create(&mutexes_.back(), &mutex_defs_.back()) == OSS_SUCCESS);
+    return &mutexes_.back();
+}
+
+void Simulator::start() {
+    os_task_options_t idle = { "idle",        OS_TASK_START_RUNNING, &task_handler_simulated, NULL, idle_stack_.data(), idle_stack_.size() * 4,
+                               OS_PRIORITY_IDLE, 0 };
+    OS_ASSERT(os_task_initialize_options(&idle_task_, &idle) == OSS_SUCCESS);
+
+    for (auto &task : tasks_) {
+        os_task_options_t options = { task.name_.c_str(), OS_TASK_START_RUNNING, &task_handler_simulated, NULL, task.stack_.data(),
+                                      task.stack_.size() * 4, task.priority_, 0 };
+        OS_ASSERT(os_task_initialize_options(&task.task_, &options) == OSS_SUCCESS);
+        os_task_user_data_set(&task.task_, &task);
+    }
+
+    OS_ASSERT(os_start() == OSS_SUCCESS);
+    osi_schedule();
+
+    started_ = true;
+}
+
+void Simulator::run(uint32_t until) {
+    if (!started_) {
+        start();
+    }
+
+    settle();
+
+    while (now_ < until) {
+        uint32_t next = next_event(until);
+        uint32_t elapsed = next - now_;
+
+        SimulatorTask *task = running();
+        if (task != nullptr) {
+            task->remaining_ -= elapsed < task->remaining_ ? elapsed : task->remaining_;
+            task->report_.cpu += elapsed;
+        } else {
+            idle_ += elapsed;
+        }
+
+        now_ = next;
+        tests_platform_time(now_);
+
+        if (now_ == until) {
+            break;
+        }
+
+        for (auto &interrupt : interrupts_) {
+            if (interrupt.next_ == now_) {
+                fire(interrupt);
+            }
+        }
+        osi_pendsv();
+        switch_task();
+
+        // Like osi_irs_systick, which only does this once os_start has
+        // switched to the first task for real.
+        if (osg.scheduled == NULL) {
+            osi_schedule();
+        }
+
+        settle();
+    }
+}
+
+double Simulator::utilization() const {
+    return now_ > 0 ? 1.0 - (double)idle_ / now_ : 0.0;
+}
+
+void Simulator::dump() const {
+    printf("%-12s %4s %6s %6s %6s %6s %6s %6s %6s\n", "task", "prio", "jobs", "misses", "min", "avg", "max", "to", "cpu%");
+    for (auto &task : tasks_) {
+        auto &r = task.report_;
+        printf("%-12s %4d %6u %6u %6u %6u %6u %6u %6.1f\n", task.name_.c_str(), task.priority_, r.jobs, r.misses,
+               r.jobs > 0 ? r.response_min : 0, r.jobs > 0 ? (uint32_t)(r.response_total / r.jobs) : 0, r.response_max, r.timeouts,
+               now_ > 0 ? r.cpu * 100.0 / now_ : 0.0);
+    }
+    printf("%-12s %4s %6s %6s %6s %6s %6s %6s %6.1f\n", "idle", "", "", "", "", "", "", "", now_ > 0 ? idle_ * 100.0 / now_ : 0.0);
+}
+
+/**
+ * Let tasks take their instantaneous steps, switching as the kernel asks,
+ * until whoever is running needs time to pass.
+ */
+void Simulator::settle() {
+    for (uint32_t i = 0;; ++i) {
+        OS_ASSERT(i < SIMULATOR_STEPS_PER_INSTANT);
+
+        switch_task();
+        notice_wakeups();
+
+        SimulatorTask *task = running();
+        if (task == nullptr || !step(*task)) {
+            return;
+        }
+    }
+}
+
+/**
+ * Returns false when the task needs time to pass.
+ */
+bool Simulator::step(SimulatorTask &task) {
+    switch (task.pending_) {
+    case SimulatorTask::Pending::Start:
+        task.pending_ = SimulatorTask::Pending::None;
+        release(task);
+        return true;
+    case SimulatorTask::Pending::Release:
+        task.pending_ = SimulatorTask::Pending::None;
+        task.release_ = task.next_release_;
+        task.step_ = 0;
+        break;
+    case SimulatorTask::Pending::Block: {
+        auto &step = task.steps_[task.step_];
+        task.pending_ = SimulatorTask::Pending::None;
+        if (step.kind != SimulatorStepKind::Sleep && osi_task_get_stacked_return(&task.task_) != OSS_SUCCESS) {
+            task.report_.timeouts++;
+        }
+        if (task.step_ == 0 && task.period_ == 0) {
+            task.release_ = task.woken_;
+        }
+        task.step_++;
+        break;
+    }
+    case SimulatorTask::Pending::None:
+        break;
+    }
+
+    if (task.remaining_ > 0) {
+        return false;
+    }
+
+    if (task.step_ == task.steps_.size()) {
+        complete(task);
+        return true;
+    }
+
+    if (task.step_ == 0 && task.period_ == 0) {
+        task.release_ = now_;
+    }
+
+    auto &step = task.steps_[task.step_];
+    switch (step.kind) {
+    case SimulatorStepKind::Compute:
+        task.remaining_ = step.duration;
+        task.step_++;
+        return true;
+    case SimulatorStepKind::Sleep:
+        svc_delay(step.duration);
+        return block(task, OSS_ERROR_TO);
+    case SimulatorStepKind::Send:
+        osi_task_set_stacked_return(&task.task_, OSS_ERROR_TO);
+        return block(task, osi_queue_enqueue((os_queue_t *)step.object, (void *)(uintptr_t)step.value, step.duration));
+    case SimulatorStepKind::Receive: {
+        void *message = NULL;
+        osi_task_set_stacked_return(&task.task_, OSS_ERROR_TO);
+        return block(task, osi_queue_dequeue((os_queue_t *)step.object, &message, step.duration));
+    }
+    case SimulatorStepKind::Take:
+        osi_task_set_stacked_return(&task.task_, OSS_ERROR_TO);
+        return block(task, osi_semaphore_acquire((os_semaphore_t *)step.object, step.duration));
+    case SimulatorStepKind::Give:
+        osi_semaphore_release((os_semaphore_t *)step.object);
+        task.step_++;
+        return true;
+    case SimulatorStepKind::Lock:
+        osi_task_set_stacked_return(&task.task_, OSS_ERROR_TO);
+        return block(task, osi_mutex_acquire((os_mutex_t *)step.object, step.duration));
+    case SimulatorStepKind::Unlock:
+        osi_mutex_release((os_mutex_t *)step.object);
+        task.step_++;
+        return true;
+    }
+
+    return true;
+}
+
+/**
+ * After a step that may block, either we're waiting and the step finishes
+ * when we run again or it's over already.
+ */
+bool Simulator::block(SimulatorTask &task, os_status_t status) {
+    if (task.task_.status == OS_TASK_STATUS_WAIT) {
+        task.pending_ = SimulatorTask::Pending::Block;
+        task.woke_ = false;
+        return true;
+    }
+    if (status != OSS_SUCCESS) {
+        task.report_.timeouts++;
+    }
+    task.step_++;
+    return true;
+}
+
+/**
+ * Start the next job, periodic tasks sleep until it's due.
+ */
+void Simulator::release(SimulatorTask &task) {
+    task.step_ = 0;
+    if (task.period_ == 0) {
+        return;
+    }
+    if (task.next_release_ > now_) {
+        svc_delay(task.next_release_ - now_);
+        task.pending_ = SimulatorTask::Pending::Release;
+    } else {
+        task.release_ = task.next_release_;
+    }
+}
+
+void Simulator::complete(SimulatorTask &task) {
+    uint32_t response = now_ - task.release_;
+    auto &r = task.report_;
+    r.jobs++;
+    r.response_total += response;
+    if (response < r.response_min) {
+        r.response_min = response;
+    }
+    if (response > r.response_max) {
+        r.response_max = response;
+    }
+    if (task.deadline_ > 0 && response > task.deadline_) {
+        r.misses++;
+    }
+
+    task.next_release_ = task.release_ + task.period_;
+    release(task);
+}
+
+/**
+ * Blocked tasks are woken by others, remember when so jobs triggered by the
+ * wake up are measured from then and not from when they got to run.
+ */
+void Simulator::notice_wakeups() {
+    for (auto &task : tasks_) {
+        if (task.pending_ == SimulatorTask::Pending::Block && !task.woke_ && task.task_.status != OS_TASK_STATUS_WAIT) {
+            task.woken_ = now_;
+            task.woke_ = true;
+        }
+    }
+}
+
+os_task_t *Simulator::switch_task() {
+    if (osg.scheduled != NULL) {
+        osg.running = osg.scheduled;
+        osg.scheduled = NULL;
+    }
+    return (os_task_t *)osg.running;
+}
+
+SimulatorTask *Simulator::running() {
+    if (osg.running == &idle_task_) {
+        return nullptr;
+    }
+    return (SimulatorTask *)os_task_user_data_get((os_task_t *)osg.running);
+}
+
+/**
+ * The kernel only changes its mind on a tick, when an interrupt fires or
+ * when the running task does something, so skip to the earliest of those
+ * that can matter.
+ */
+uint32_t Simulator::next_event(uint32_t until) {
+    uint32_t next = until;
+
+    SimulatorTask *task = running();
+    if (task != nullptr && task->remaining_ > 0 && now_ + task->remaining_ < next) {
+        next = now_ + task->remaining_;
+    }
+
+    for (auto &interrupt : interrupts_) {
+        if (interrupt.next_ > now_ && interrupt.next_ < next) {
+            next = interrupt.next_;
+        }
+    }
+
+    // Sleepers are only woken on a tick, and one at a time.
+    os_task_t *sleeper = osg.waitqueue;
+    if (sleeper != NULL && sleeper->delay != UINT32_MAX) {
+        uint32_t due = sleeper->delay > now_ ? sleeper->delay : now_ + 1;
+        if (due < next) {
+            next = due;
+        }
+    }
+
+    // Round robin happens on ticks too.
+    os_task_t *current = (os_task_t *)osg.running;
+    for (os_task_t *iter = osg.runqueue; iter != NULL; iter = iter->nrp) {
+        if (iter != current && os_task_status_is_running(iter->status) && iter->priority >= current->priority &&
+            current != &idle_task_) {
+            if (now_ + 1 < next) {
+                next = now_ + 1;
+            }
+            break;
+        }
+    }
+
+    return next;
+}
+
+void Simulator::fire(SimulatorInterrupt &interrupt) {
+    for (auto &step : interrupt.steps_) {
+        switch (step.kind) {
+        case SimulatorStepKind::Give:
+            osi_semaphore_release_isr((os_semaphore_t *)step.object);
+            break;
+        case SimulatorStepKind::Send:
+            osi_queue_enqueue_isr((os_queue_t *)step.object, (void *)(uintptr_t)step.value);
+            break;
+        default:
+            OS_ASSERT(false);
+            break;
+        }
+    }
+
+    interrupt.fired_++;
+    interrupt.next_ = interrupt.period_ > 0 ? interrupt.next_ + interrupt.period_ : UINT32_MAX;
+}
@@ -0,0 +1,228 @@
+/**
+ * This software is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * This is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this source code. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef OS_TESTS_SIMULATOR_H
+#define OS_TESTS_SIMULATOR_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <os.h>
+#include <internal.h>
+
+/**
+ * Wait for as long as it takes.
+ */
+#define SIMULATOR_FOREVER UINT32_MAX
+
+/**
+ * Most steps a task may take without time passing, catches scripts that
+ * never compute or block.
+ */
+#define SIMULATOR_STEPS_PER_INSTANT (10000)
+
+enum class SimulatorStepKind {
+    Compute,
+    Sleep,
+    Send,
+    Receive,
+    Take,
+    Give,
+    Lock,
+    Unlock,
+};
+
+struct SimulatorStep {
+    SimulatorStepKind kind;
+    uint32_t duration;
+    void *object;
+    uint32_t value;
+};
+
+struct SimulatorReport {
+    uint32_t jobs;     //! Completed passes through the script. */
+    uint32_t misses;   //! Jobs that took longer than the deadline. */
+    uint32_t timeouts; //! Blocking steps that gave up. */
+    uint32_t response_min;
+    uint32_t response_max;
+    uint64_t response_total;
+    uint32_t cpu; //! Milliseconds spent computing. */
+};
+
+class Simulator;
+
+/**
+ * A task following a script, one pass through the script is a job.
+ *
+ * Periodic tasks release a job every period starting at offset and sleep
+ * in between, response times are measured from the release. Other tasks
+ * loop over their script, and their jobs are released when the first step
+ * completes, usually that's blocking on whatever triggers them.
+ */
+class SimulatorTask {
+    friend class Simulator;
+
+public:
+    SimulatorTask(const char *name, os_priority_t priority, uint32_t period, uint32_t deadline, uint32_t offset);
+
+public:
+    SimulatorTask &compute(uint32_t ms);
+    SimulatorTask &sleep(uint32_t ms);
+    SimulatorTask &send(os_queue_t *queue, uint32_t value, uint32_t to = SIMULATOR_FOREVER);
+    SimulatorTask &receive(os_queue_t *queue, uint32_t to = SIMULATOR_FOREVER);
+    SimulatorTask &take(os_semaphore_t *semaphore, uint32_t to = SIMULATOR_FOREVER);
+    SimulatorTask &give(os_semaphore_t *semaphore);
+    SimulatorTask &lock(os_mutex_t *mutex, uint32_t to = SIMULATOR_FOREVER);
+    SimulatorTask &unlock(os_mutex_t *mutex);
+
+    os_task_t *task() {
+        return &task_;
+    }
+
+    const SimulatorReport &report() const {
+        return report_;
+    }
+
+private:
+    enum class Pending {
+        None,
+        Start,
+        Release,
+        Block,
+    };
+
+    SimulatorTask &add(SimulatorStepKind kind, uint32_t duration, void *object, uint32_t value);
+
+private:
+    std::string name_;
+    os_priority_t priority_;
+    uint32_t period_;
+    uint32_t deadline_;
+    std::vector<SimulatorStep> steps_;
+    os_task_t task_;
+    std::vector<uint32_t> stack_;
+    size_t step_{ 0 };
+    uint32_t remaining_{ 0 };
+    Pending pending_{ Pending::Start };
+    uint32_t release_{ 0 };
+    uint32_t next_release_;
+    uint32_t woken_{ 0 };
+    bool woke_{ false };
+    SimulatorReport report_{ 0, 0, 0, UINT32_MAX, 0, 0, 0 };
+};
+
+/**
+ * Fires at first and then every period, if there is one, doing every step
+ * from interrupt context. Only give and send make sense here.
+ */
+class SimulatorInterrupt {
+    friend class Simulator;
+
+public:
+    SimulatorInterrupt(const char *name, uint32_t first, uint32_t period);
+
+public:
+    SimulatorInterrupt &give(os_semaphore_t *semaphore);
+    SimulatorInterrupt &send(os_queue_t *queue, uint32_t value);
+
+    uint32_t fired() const {
+        return fired_;
+    }
+
+private:
+    std::string name_;
+    uint32_t next_;
+    uint32_t period_;
+    uint32_t fired_{ 0 };
+    std::vector<SimulatorStep> steps_;
+};
+
+/**
+ * Discrete event simulation of the hosted kernel in virtual milliseconds.
+ *
+ * Time only moves while the running task computes, and jumps straight to
+ * the next thing that could change what runs: a computation finishing, an
+ * interrupt, a sleeper's deadline or a round robin tick. The kernel does
+ * all the scheduling, this only stands in for the hardware and the tasks.
+ */
+class Simulator {
+public:
+    Simulator();
+    ~Simulator();
+
+public:
+    SimulatorTask &task(const char *name, os_priority_t priority, uint32_t period = 0, uint32_t deadline = 0, uint32_t offset = 0);
+    SimulatorInterrupt &interrupt(const char *name, uint32_t first, uint32_t period = 0);
+    os_queue_t *queue(const char *name, uint16_t size);
+    os_semaphore_t *semaphore(const char *name, uint32_t tokens);
+    os_mutex_t *mutex(const char *name);
+
+    /**
+     * Starts the kernel the first time, then simulates until the given
+     * virtual time.
+     */
+    void run(uint32_t until);
+
+    uint32_t now() const {
+        return now_;
+    }
+
+    /**
+     * Milliseconds nobody had anything to do.
+     */
+    uint32_t idle() const {
+        return idle_;
+    }
+
+    /**
+     * Busy fraction of the time simulated so far.
+     */
+    double utilization() const;
+
+    /**
+     * One line per task, for eyeballing scenarios.
+     */
+    void dump() const;
+
+private:
+    void start();
+    void settle();
+    bool step(SimulatorTask &task);
+    bool block(SimulatorTask &task, os_status_t status);
+    void release(SimulatorTask &task);
+    void complete(SimulatorTask &task);
+    void notice_wakeups();
+    os_task_t *switch_task();
+    SimulatorTask *running();
+    uint32_t next_event(uint32_t until);
+    void fire(SimulatorInterrupt &interrupt);
+
+private:
+    bool started_{ false };
+    uint32_t now_{ 0 };
+    uint32_t idle_{ 0 };
+    os_task_t idle_task_;
+    std::vector<uint32_t> idle_stack_;
+    std::deque<SimulatorTask> tasks_;
+    std::deque<SimulatorInterrupt> interrupts_;
+    std::deque<std::string> names_;
+    std::deque<os_queue_definition_t> queue_defs_;
+    std::deque<std::vector<uint32_t>> queues_;
+    std::deque<os_semaphore_definition_t> semaphore_defs_;
+    std::deque<os_semaphore_t> semaphores_;
+    std::deque<os_mutex_definition_t> mutex_defs_;
+    std::deque<os_mutex_t> mutexes_;
+};
+
+#endif // OS_TESTS_SIMULATOR_H
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+class SupervisorSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+
+    std::string path;
+};
+
+// Giving up panics, which leaves a crash snapshot.
+void SupervisorSuite::SetUp() {
+    tests_platform_time(0);
+    path = tests_crash_file_setup("supervisor");
+}
+
+void SupervisorSuite::TearDown() {
+    tests_crash_file_teardown(path);
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+TEST_F(SupervisorSuite, Abort_RestartsWithoutLocks) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_supervisor_t supervisor;
+    os_supervisor_child_t child;
+    ASSERT_EQ(os_supervisor_create(&supervisor, "sup", 3, 1000), OSS_SUCCESS);
+    ASSERT_EQ(os_supervisor_add(&supervisor, &child, &tasks[1], OS_RESTART_PERMANENT), OSS_SUCCESS);
+    ASSERT_TRUE(osi_supervised(&tasks[1]));
+    ASSERT_FALSE(osi_supervised(&tasks[2]));
+
+    os_mutex_t mutex;
+    os_mutex_definition_t mutex_def = { "mutex" };
+    ASSERT_EQ(osi_mutex_create(&mutex, &mutex_def), OSS_SUCCESS);
+    os_rwlock_t rwlock;
+    os_rwlock_definition_t rwlock_def = { "rwlock" };
+    ASSERT_EQ(osi_rwlock_create(&rwlock, &rwlock_def), OSS_SUCCESS);
+
+    // task-1 takes both, twice over for the mutex.
+    ASSERT_EQ(osg.running, &tasks[1]);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 500), OSS_SUCCESS);
+    ASSERT_EQ(osi_rwlock_acquire_write(&rwlock, 500), OSS_SUCCESS);
+
+    // task-2 blocks on the mutex.
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[2]);
+    osi_task_set_stacked_return(&tasks[2], OSS_ERROR_TO);
+    ASSERT_EQ(osi_mutex_acquire(&mutex, 5000), OSS_ERROR_TO);
+    ASSERT_EQ(tests_task_switch(), &tasks[0]);
+
+    // task-1 wakes up and aborts, which hands the mutex over right away.
+    tests_platform_time(1000);
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+    svc_abort(0);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+    ASSERT_EQ(tasks[1].status, OS_TASK_STATUS_ABORTED);
+    ASSERT_EQ(mutex.owner, &tasks[2]);
+    ASSERT_EQ(mutex.level, 1);
+    ASSERT_EQ(osi_task_get_stacked_return(&tasks[2]), OSS_ERROR_OWNER_DIED);
+    ASSERT_EQ(rwlock.writer, nullptr);
+    ASSERT_EQ(rwlock.writers, 0);
+
+    tests_platform_time(1010);
+    ASSERT_EQ(osi_supervise(), OSS_SUCCESS);
+    ASSERT_EQ(tasks[1].status, OS_TASK_STATUS_IDLE);
+    ASSERT_EQ(child.restarts, 1u);
+
+    // Nothing more to do.
+    ASSERT_EQ(osi_supervise(), OSS_SUCCESS);
+    ASSERT_EQ(child.restarts, 1u);
+}
+
+TEST_F(SupervisorSuite, RestartPolicies) {
+    os_task_t tasks[4];
+    uint32_t stacks[4][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    four_tasks_setup(tasks, stacks);
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[2]);
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[3]);
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[0]);
+
+    os_supervisor_t supervisor;
+    os_supervisor_child_t children[3];
+    ASSERT_EQ(os_supervisor_create(&supervisor, "sup", 8, 1000), OSS_SUCCESS);
+    ASSERT_EQ(os_supervisor_add(&supervisor, &children[0], &tasks[1], OS_RESTART_PERMANENT), OSS_SUCCESS);
+    ASSERT_EQ(os_supervisor_add(&supervisor, &children[1], &tasks[2], OS_RESTART_TRANSIENT), OSS_SUCCESS);
+    ASSERT_EQ(os_supervisor_add(&supervisor, &children[2], &tasks[3], OS_RESTART_TEMPORARY), OSS_SUCCESS);
+    ASSERT_FALSE(osi_supervised(&tasks[3]));
+
+    // Finishing normally only matters to permanent children.
+    for (size_t i = 1; i < 4; ++i) {
+        tasks[i].status = OS_TASK_STATUS_FINISHED;
+    }
+    ASSERT_EQ(osi_supervise(), OSS_SUCCESS);
+    ASSERT_EQ(tasks[1].status, OS_TASK_STATUS_IDLE);
+    ASSERT_EQ(tasks[2].status, OS_TASK_STATUS_FINISHED);
+    ASSERT_EQ(tasks[3].status, OS_TASK_STATUS_FINISHED);
+
+    tasks[2].status = OS_TASK_STATUS_PANIC;
+    tasks[3].status = OS_TASK_STATUS_PANIC;
+    ASSERT_EQ(osi_supervise(), OSS_SUCCESS);
+    ASSERT_EQ(tasks[2].status, OS_TASK_STATUS_IDLE);
+    ASSERT_EQ(tasks[3].status, OS_TASK_STATUS_PANIC);
+}
+
+TEST_F(SupervisorSuite, Intensity_GivesUpAfterTooManyRestarts) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[2]);
+
+    os_supervisor_t supervisor;
+    os_supervisor_child_t child;
+    ASSERT_EQ(os_supervisor_create(&supervisor, "sup", 2, 100), OSS_SUCCESS);
+    ASSERT_EQ(os_supervisor_add(&supervisor, &child, &tasks[1], OS_RESTART_PERMANENT), OSS_SUCCESS);
+
+    // Two restarts within the period are fine, and once the first ages out
+    // there's room for another.
+    uint32_t times[] = { 10, 20, 115 };
+    for (uint32_t now : times) {
+        tests_platform_time(now);
+        tasks[1].status = OS_TASK_STATUS_ABORTED;
+        ASSERT_EQ(osi_supervise(), OSS_SUCCESS);
+        ASSERT_EQ(tasks[1].status, OS_TASK_STATUS_IDLE);
+    }
+    ASSERT_EQ(child.restarts, 3u);
+
+    tests_platform_time(118);
+    tasks[1].status = OS_TASK_STATUS_ABORTED;
+    ASSERT_EQ(osi_supervise(), OSS_ERROR);
+    ASSERT_TRUE(supervisor.failed);
+    ASSERT_EQ(tasks[1].status, OS_TASK_STATUS_ABORTED);
+    ASSERT_FALSE(osi_supervised(&tasks[1]));
+}
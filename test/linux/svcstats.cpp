@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+#include <syscalls.h>
+
+#include "utilities.h"
+
+#if defined(OS_CONFIG_SVC_STATS)
+
+class SvcStatsSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void SvcStatsSuite::SetUp() {
+    tests_platform_time(0);
+    ASSERT_EQ(os_svc_stats_reset(), OSS_SUCCESS);
+}
+
+void SvcStatsSuite::TearDown() {
+    ASSERT_EQ(os_svc_stats_reset(), OSS_SUCCESS);
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+/**
+ * Hosted wrappers call svc_* directly, so go through the table like the SVC
+ * handler does. Only integer arguments, pointers don't fit on a 64-bit host.
+ */
+static uint32_t svc_call(uint32_t number, uint32_t a1 = 0) {
+    typedef uint64_t (*handler_t)(uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4);
+    return (uint32_t)((handler_t)osi_svc_table[number])(a1, 0, 0, 0);
+}
+
+TEST_F(SvcStatsSuite, TableCallsAreCounted) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(svc_call(OS_SVC_svc_reschedule), OSS_SUCCESS);
+    ASSERT_EQ(svc_call(OS_SVC_svc_reschedule), OSS_SUCCESS);
+    tests_schedule_task_and_switch();
+
+    ASSERT_EQ(svc_call(OS_SVC_svc_delay, 100), (uint32_t)OSS_ERROR_TO);
+    tests_schedule_task_and_switch();
+
+    ASSERT_EQ(osi_svc_invalid(), (uint32_t)OSS_ERROR_INVALID);
+
+    os_svc_stats_t stats;
+
+    ASSERT_EQ(os_svc_stats_get(OS_SVC_svc_reschedule, &stats), OSS_SUCCESS);
+    ASSERT_STREQ(stats.name, "svc_reschedule");
+    ASSERT_EQ(stats.calls, 2u);
+    ASSERT_EQ(stats.buckets[0], 2u);
+
+    ASSERT_EQ(os_svc_stats_get(OS_SVC_svc_delay, &stats), OSS_SUCCESS);
+    ASSERT_STREQ(stats.name, "svc_delay");
+    ASSERT_EQ(stats.calls, 1u);
+
+    ASSERT_EQ(os_svc_stats_get(OS_SVC_NONE, &stats), OSS_SUCCESS);
+    ASSERT_STREQ(stats.name, "svc_invalid");
+    ASSERT_EQ(stats.calls, 1u);
+
+    ASSERT_EQ(os_svc_stats_get(OS_SVC_svc_mutex_acquire, &stats), OSS_SUCCESS);
+    ASSERT_EQ(stats.calls, 0u);
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < os_svc_stats_size(); ++i) {
+        ASSERT_EQ(os_svc_stats_get(i, &stats), OSS_SUCCESS);
+        for (uint32_t b = 0; b < OS_SVC_STATS_BUCKETS; ++b) {
+            total += stats.buckets[b];
+        }
+    }
+    ASSERT_EQ(total, 4u);
+
+    ASSERT_EQ(os_svc_stats_get(os_svc_stats_size(), &stats), OSS_ERROR_INVALID);
+
+    ASSERT_EQ(os_svc_stats_dump(), OSS_SUCCESS);
+}
+
+TEST_F(SvcStatsSuite, Reset_ClearsCounts) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(svc_call(OS_SVC_svc_reschedule), OSS_SUCCESS);
+    ASSERT_EQ(osi_svc_invalid(), (uint32_t)OSS_ERROR_INVALID);
+
+    ASSERT_EQ(os_svc_stats_reset(), OSS_SUCCESS);
+
+    os_svc_stats_t stats;
+    ASSERT_EQ(os_svc_stats_get(OS_SVC_svc_reschedule, &stats), OSS_SUCCESS);
+    ASSERT_EQ(stats.calls, 0u);
+    ASSERT_EQ(stats.cycles, 0u);
+    ASSERT_EQ(stats.buckets[0], 0u);
+
+    ASSERT_EQ(os_svc_stats_get(OS_SVC_NONE, &stats), OSS_SUCCESS);
+    ASSERT_EQ(stats.calls, 0u);
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+class PreemptionThresholdSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+};
+
+void PreemptionThresholdSuite::SetUp() {
+    tests_platform_time(0);
+}
+
+void PreemptionThresholdSuite::TearDown() {
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+TEST_F(PreemptionThresholdSuite, ThreeTasks_WakeAtOrBelowThreshold_Queued) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    // Safe because task-2 is sleeping and will be resorted when it wakes.
+    tests_sleep_task(tasks[2]);
+    tasks[2].priority = OS_PRIORITY_NORMAL + 2;
+    tasks[1].preemption_threshold = OS_PRIORITY_NORMAL + 2;
+
+    ASSERT_EQ(osi_dispatch_or_queue(&tasks[2]), OSS_SUCCESS);
+    ASSERT_EQ(osg.scheduled, nullptr);
+    ASSERT_EQ(tasks[2].status, OS_TASK_STATUS_IDLE);
+
+    /* No round robin either. */
+    ASSERT_EQ(tests_schedule_task_and_switch(), &tasks[1]);
+
+    /* Once task-1 blocks the more important task gets to go. */
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[2]);
+}
+
+TEST_F(PreemptionThresholdSuite, ThreeTasks_WakeAboveThreshold_Preempts) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    tests_sleep_task(tasks[2]);
+    tasks[2].priority = OS_PRIORITY_NORMAL + 3;
+    tasks[1].preemption_threshold = OS_PRIORITY_NORMAL + 2;
+
+    ASSERT_EQ(osi_dispatch_or_queue(&tasks[2]), OSS_SUCCESS);
+    ASSERT_EQ(tests_task_switch(), &tasks[2]);
+}
+
+typedef struct workload_task_t {
+    const char *name;
+    os_priority_t priority;
+    os_priority_t preemption_threshold;
+    uint32_t period;
+    uint32_t work;
+} workload_task_t;
+
+typedef struct workload_results_t {
+    uint32_t switches;
+    uint32_t urgent_delayed;
+} workload_results_t;
+
+static void workload_switch(workload_results_t &results) {
+    if (osg.scheduled != NULL) {
+        tests_task_switch();
+        results.switches++;
+    }
+}
+
+/**
+ * A low priority task doing long bursts of work alongside a few neighboring
+ * priority tasks that wake periodically and one urgent task, all driven one
+ * tick at a time. The last definition is the urgent one.
+ */
+template <size_t N> static workload_results_t run_mixed_workload(workload_task_t (&definitions)[N], uint32_t ticks) {
+    os_task_t idle;
+    os_task_t tasks[N];
+    uint32_t remaining[N];
+    uint32_t stacks[N + 1][OS_STACK_MINIMUM_SIZE_WORDS];
+    workload_results_t results = { 0, 0 };
+
+    EXPECT_EQ(os_initialize(), OSS_SUCCESS);
+    EXPECT_EQ(os_task_initialize(&idle, "idle", OS_TASK_START_RUNNING, &task_handler_idle, NULL, stacks[0], sizeof(stacks[0])),
+              OSS_SUCCESS);
+    for (size_t i = 0; i < N; ++i) {
+        os_task_options_t options = { definitions[i].name, OS_TASK_START_RUNNING, &task_handler_test, NULL,
+                                      stacks[i + 1],       sizeof(stacks[i + 1]), definitions[i].priority,
+                                      definitions[i].preemption_threshold };
+        EXPECT_EQ(os_task_initialize_options(&tasks[i], &options), OSS_SUCCESS);
+        remaining[i] = definitions[i].work;
+    }
+    EXPECT_EQ(os_start(), OSS_SUCCESS);
+    workload_switch(results);
+
+    for (uint32_t tick = 1; tick <= ticks; ++tick) {
+        for (size_t i = 0; i < N; ++i) {
+            if (tick % definitions[i].period == 0 && tasks[i].status == OS_TASK_STATUS_WAIT) {
+                osi_dispatch_or_queue(&tasks[i]);
+                workload_switch(results);
+                if (i == N - 1 && osg.running != &tasks[i]) {
+                    results.urgent_delayed++;
+                }
+            }
+        }
+
+        osi_schedule();
+        workload_switch(results);
+
+        for (size_t i = 0; i < N; ++i) {
+            if (osg.running == &tasks[i]) {
+                if (--remaining[i] == 0) {
+                    remaining[i] = definitions[i].work;
+                    osi_task_status_set(&tasks[i], OS_TASK_STATUS_WAIT);
+                    tasks[i].delay = UINT32_MAX;
+                    osi_schedule();
+                    workload_switch(results);
+                }
+                break;
+            }
+        }
+    }
+
+    EXPECT_EQ(os_teardown(), OSS_SUCCESS);
+
+    return results;
+}
+
+TEST_F(PreemptionThresholdSuite, MixedWorkload_FewerSwitches) {
+    workload_task_t plain[] = {
+        { "low", OS_PRIORITY_NORMAL + 0, 0, 50, 20 },   { "medium-a", OS_PRIORITY_NORMAL + 1, 0, 7, 2 },
+        { "medium-b", OS_PRIORITY_NORMAL + 1, 0, 9, 2 }, { "medium-c", OS_PRIORITY_NORMAL + 2, 0, 11, 2 },
+        { "urgent", OS_PRIORITY_NORMAL + 8, 0, 13, 1 },
+    };
+    workload_task_t thresholds[] = {
+        { "low", OS_PRIORITY_NORMAL + 0, OS_PRIORITY_NORMAL + 2, 50, 20 },
+        { "medium-a", OS_PRIORITY_NORMAL + 1, OS_PRIORITY_NORMAL + 2, 7, 2 },
+        { "medium-b", OS_PRIORITY_NORMAL + 1, OS_PRIORITY_NORMAL + 2, 9, 2 },
+        { "medium-c", OS_PRIORITY_NORMAL + 2, 0, 11, 2 },
+        { "urgent", OS_PRIORITY_NORMAL + 8, 0, 13, 1 },
+    };
+
+    workload_results_t without = run_mixed_workload(plain, 10000);
+    workload_results_t with = run_mixed_workload(thresholds, 10000);
+
+    RecordProperty("SwitchesWithoutThreshold", (int)without.switches);
+    RecordProperty("SwitchesWithThreshold", (int)with.switches);
+
+    ASSERT_LT(with.switches, without.switches);
+    ASSERT_EQ(without.urgent_delayed, 0u);
+    ASSERT_EQ(with.urgent_delayed, 0u);
+}
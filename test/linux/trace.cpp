@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+typedef struct trace_event_t {
+    uint32_t id;
+    std::vector<uint32_t> values;
+    std::string name;
+} trace_event_t;
+
+class TraceSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+
+    std::vector<trace_event_t> events();
+};
+
+void TraceSuite::SetUp() {
+    tests_platform_time(0);
+}
+
+void TraceSuite::TearDown() {
+    ASSERT_EQ(os_trace_stop(), OSS_SUCCESS);
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+static uint32_t decode_u32(const std::vector<uint8_t> &data, size_t &offset) {
+    uint32_t value = 0;
+    for (uint32_t shift = 0; offset < data.size(); shift += 7) {
+        uint8_t byte = data[offset++];
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    return value;
+}
+
+static std::string decode_str(const std::vector<uint8_t> &data, size_t &offset) {
+    uint8_t length = data[offset++];
+    std::string value(data.begin() + offset, data.begin() + offset + length);
+    offset += length;
+    return value;
+}
+
+/**
+ * Just enough of a SystemView recorder to check the stream, events before
+ * id 24 have a fixed number of values and the rest carry their length.
+ */
+std::vector<trace_event_t> TraceSuite::events() {
+    std::vector<uint8_t> data;
+    uint8_t buffer[256];
+    uint32_t read;
+    while ((read = tests_trace_read(buffer, sizeof(buffer))) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+
+    size_t offset = 0;
+    while (offset < data.size() && data[offset] == 0) {
+        offset++;
+    }
+
+    std::vector<trace_event_t> decoded;
+    while (offset < data.size()) {
+        trace_event_t event;
+        event.id = decode_u32(data, offset);
+        switch (event.id) {
+        case OS_TRACE_EVENT_TASK_INFO:
+            event.values.push_back(decode_u32(data, offset));
+            event.values.push_back(decode_u32(data, offset));
+            event.name = decode_str(data, offset);
+            break;
+        case OS_TRACE_EVENT_SYSDESC:
+            event.name = decode_str(data, offset);
+            break;
+        case OS_TRACE_EVENT_SYSTIME_US:
+        case OS_TRACE_EVENT_TASK_STOP_READY:
+            event.values.push_back(decode_u32(data, offset));
+            event.values.push_back(decode_u32(data, offset));
+            break;
+        case OS_TRACE_EVENT_OVERFLOW:
+        case OS_TRACE_EVENT_ISR_ENTER:
+        case OS_TRACE_EVENT_TASK_START_EXEC:
+        case OS_TRACE_EVENT_TASK_START_READY:
+        case OS_TRACE_EVENT_TASK_CREATE:
+        case OS_TRACE_EVENT_TIMER_ENTER:
+            event.values.push_back(decode_u32(data, offset));
+            break;
+        default:
+            if (event.id >= 24) {
+                size_t length = decode_u32(data, offset);
+                size_t stop = offset + length;
+                while (offset < stop) {
+                    event.values.push_back(decode_u32(data, offset));
+                }
+            }
+            break;
+        }
+        decode_u32(data, offset); // Timestamp delta.
+        decoded.push_back(event);
+    }
+    return decoded;
+}
+
+static uint32_t id_of(os_task_t &task) {
+    return (uint32_t)(uintptr_t)&task;
+}
+
+static bool contains(const std::vector<trace_event_t> &events, uint32_t id, uint32_t value) {
+    for (auto &event : events) {
+        if (event.id == id && !event.values.empty() && event.values[0] == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_F(TraceSuite, Start_DescribesSystemAndTasks) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(os_trace_start(), OSS_SUCCESS);
+
+    auto decoded = events();
+    ASSERT_GE(decoded.size(), 7u);
+    ASSERT_EQ(decoded[0].id, (uint32_t)OS_TRACE_EVENT_TRACE_START);
+    ASSERT_EQ(decoded[1].id, (uint32_t)OS_TRACE_EVENT_INIT);
+    ASSERT_EQ(decoded[1].values[0], 1000000u);
+    ASSERT_EQ(decoded[2].id, (uint32_t)OS_TRACE_EVENT_SYSDESC);
+    ASSERT_EQ(decoded[3].id, (uint32_t)OS_TRACE_EVENT_SYSTIME_US);
+
+    uint32_t infos = 0;
+    for (auto &event : decoded) {
+        if (event.id == OS_TRACE_EVENT_TASK_INFO) {
+            infos++;
+            if (event.values[0] == id_of(tasks[1])) {
+                ASSERT_EQ(event.name, tasks[1].name);
+                ASSERT_EQ(event.values[1], tasks[1].priority);
+            }
+        }
+    }
+    ASSERT_EQ(infos, 3u);
+}
+
+TEST_F(TraceSuite, SleepAndWake_ReadyAndExecEvents) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(os_trace_start(), OSS_SUCCESS);
+    events();
+
+    ASSERT_EQ(tests_sleep_running_task(), &tasks[2]);
+
+    auto decoded = events();
+    ASSERT_TRUE(contains(decoded, OS_TRACE_EVENT_TASK_STOP_READY, id_of(tasks[1])));
+    ASSERT_TRUE(contains(decoded, OS_TRACE_EVENT_TASK_START_EXEC, id_of(tasks[2])));
+
+    ASSERT_EQ(osi_dispatch_or_queue(&tasks[1]), OSS_SUCCESS);
+
+    decoded = events();
+    ASSERT_TRUE(contains(decoded, OS_TRACE_EVENT_TASK_START_READY, id_of(tasks[1])));
+    ASSERT_EQ(os_trace_dropped(), 0u);
+}
+
+TEST_F(TraceSuite, Terminate_LengthPrefixed) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    ASSERT_EQ(os_trace_start(), OSS_SUCCESS);
+    events();
+
+    osi_task_status_set(&tasks[2], OS_TASK_STATUS_FINISHED);
+
+    auto decoded = events();
+    ASSERT_TRUE(contains(decoded, OS_TRACE_EVENT_TASK_TERMINATE, id_of(tasks[2])));
+}
@@ -13,6 +13,8 @@
  */
 #include "utilities.h"
 
+#include <stdlib.h>
+
 #include <internal.h>
 
 void PrintTo(os_task_t *task, std::ostream *os) {
@@ -34,6 +36,11 @@ void PrintTo(volatile os_task_t *task, std::ostream *os) {
 os_task_t *tests_task_switch(void) {
     OS_ASSERT(osg.scheduled != NULL);
 
+    // PendSV traces the switch from osi_stack_check, do the same here.
+    if (osg.scheduled != osg.running) {
+        OS_TRACE_TASK_SWITCH((os_task_t *)osg.scheduled);
+    }
+
     osg.running = osg.scheduled;
     osg.scheduled = NULL;
 
@@ -83,6 +90,20 @@ void tests_dump_waitqueue() {
     std::cerr << std::endl;
 }
 
+std::string tests_crash_file_setup(const char *name) {
+    std::string path = ::testing::TempDir() + "osh-" + name + "-test.txt";
+    setenv("OS_CRASH_FILE", path.c_str(), 1);
+    return path;
+}
+
+void tests_crash_file_teardown(const std::string &path) {
+    unsetenv("OS_CRASH_FILE");
+    remove(path.c_str());
+#if defined(OS_CONFIG_CRASH_SNAPSHOT)
+    ASSERT_EQ(os_crash_clear(), OSS_SUCCESS);
+#endif
+}
+
 void task_handler_idle(void *p) {
 }
 
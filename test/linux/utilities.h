@@ -31,6 +31,14 @@ void tests_dump_runqueue();
 
 void tests_dump_waitqueue();
 
+/**
+ * Points OS_CRASH_FILE at a temporary file named after the suite and returns
+ * its path, for suites that panic and leave a crash snapshot behind.
+ */
+std::string tests_crash_file_setup(const char *name);
+
+void tests_crash_file_teardown(const std::string &path);
+
 void task_handler_idle(void *p);
 
 void task_handler_test(void *p);
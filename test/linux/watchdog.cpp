@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <os.h>
+#include <internal.h>
+
+#include "utilities.h"
+
+class WatchdogSuite : public ::testing::Test {
+protected:
+    virtual void SetUp();
+    virtual void TearDown();
+
+    std::string path;
+};
+
+void WatchdogSuite::SetUp() {
+    tests_platform_time(0);
+    path = tests_crash_file_setup("watchdog");
+}
+
+void WatchdogSuite::TearDown() {
+    tests_crash_file_teardown(path);
+    ASSERT_EQ(os_teardown(), OSS_SUCCESS);
+}
+
+TEST_F(WatchdogSuite, FedWhileTasksCheckIn) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_watchdog_t watchdogs[2];
+    ASSERT_EQ(os_watchdog_start(100), OSS_SUCCESS);
+    ASSERT_EQ(os_watchdog_register(&watchdogs[0], &tasks[1], 50), OSS_SUCCESS);
+    ASSERT_EQ(os_watchdog_register(&watchdogs[1], &tasks[2], 30), OSS_SUCCESS);
+
+    for (uint32_t now = 10; now <= 500; now += 10) {
+        tests_platform_time(now);
+        if (now % 40 == 0) {
+            ASSERT_EQ(os_watchdog_checkin(&watchdogs[0]), OSS_SUCCESS);
+        }
+        if (now % 20 == 0) {
+            ASSERT_EQ(os_watchdog_checkin(&watchdogs[1]), OSS_SUCCESS);
+        }
+        osi_watchdog_supervise();
+        ASSERT_FALSE(tests_watchdog_expired());
+    }
+
+    ASSERT_EQ(os_watchdog_overdue(), nullptr);
+    ASSERT_EQ(tests_watchdog_feeds(), 50u);
+    ASSERT_EQ(os_crash_snapshot(), nullptr);
+}
+
+TEST_F(WatchdogSuite, MissedCheckIn_StopsFeedingAndRecordsTask) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_watchdog_t watchdogs[2];
+    ASSERT_EQ(os_watchdog_start(100), OSS_SUCCESS);
+    ASSERT_EQ(os_watchdog_register(&watchdogs[0], &tasks[1], 50), OSS_SUCCESS);
+    ASSERT_EQ(os_watchdog_register(&watchdogs[1], &tasks[2], 50), OSS_SUCCESS);
+
+    // Only task-1 keeps checking in.
+    for (uint32_t now = 10; now <= 200; now += 10) {
+        tests_platform_time(now);
+        ASSERT_EQ(os_watchdog_checkin(&watchdogs[0]), OSS_SUCCESS);
+        osi_watchdog_supervise();
+    }
+
+    ASSERT_EQ(os_watchdog_overdue(), &watchdogs[1]);
+    ASSERT_EQ(tests_watchdog_feeds(), 5u);
+    ASSERT_TRUE(tests_watchdog_expired());
+
+    // Checking in late doesn't save us.
+    ASSERT_EQ(os_watchdog_checkin(&watchdogs[1]), OSS_SUCCESS);
+    osi_watchdog_supervise();
+    ASSERT_EQ(tests_watchdog_feeds(), 5u);
+
+    os_crash_snapshot_t *snapshot = os_crash_snapshot();
+    ASSERT_NE(snapshot, nullptr);
+    ASSERT_EQ(snapshot->kind, (uint32_t)OS_PANIC_WATCHDOG);
+    ASSERT_EQ(snapshot->uptime, 60u);
+    ASSERT_STREQ(snapshot->watchdog, "task-2");
+}
+
+TEST_F(WatchdogSuite, SuspendedTasksAreLeftAlone) {
+    os_task_t tasks[3];
+    uint32_t stacks[3][OS_STACK_MINIMUM_SIZE_WORDS];
+
+    three_tasks_setup(tasks, stacks);
+
+    os_watchdog_t watchdog;
+    ASSERT_EQ(os_watchdog_start(100), OSS_SUCCESS);
+    ASSERT_EQ(os_watchdog_register(&watchdog, &tasks[2], 50), OSS_SUCCESS);
+    ASSERT_EQ(os_task_suspend(&tasks[2]), OSS_SUCCESS);
+
+    for (uint32_t now = 10; now <= 300; now += 10) {
+        tests_platform_time(now);
+        osi_watchdog_supervise();
+    }
+    ASSERT_EQ(os_watchdog_overdue(), nullptr);
+
+    // After resuming there's a whole period before the next check-in.
+    ASSERT_EQ(os_task_resume(&tasks[2]), OSS_SUCCESS);
+    tests_platform_time(350);
+    osi_watchdog_supervise();
+    ASSERT_EQ(os_watchdog_overdue(), nullptr);
+    tests_platform_time(360);
+    osi_watchdog_supervise();
+    ASSERT_EQ(os_watchdog_overdue(), &watchdog);
+
+    ASSERT_EQ(os_watchdog_unregister(&watchdog), OSS_SUCCESS);
+    ASSERT_EQ(os_watchdog_unregister(&watchdog), OSS_ERROR_INVALID);
+}
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+#
+# Decode the binary log written by os_log. Format strings are looked up in
+# the .os_log section of the firmware ELF, the log itself is whatever was
+# captured from the RTT channel, for example with JLinkRTTLogger:
+#
+#   JLinkRTTLogger -Device ATSAMD51J19 -If SWD -Speed 4000 -RTTChannel 1 log.bin
+#   tools/oslog.py firmware.elf log.bin
+#
+
+import argparse
+import re
+import struct
+import sys
+
+CONVERSION = re.compile(r"%([-+ 0#]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t)?([diuxXoscpfFeEgG%])")
+
+
+class Elf:
+    def __init__(self, data):
+        if data[:4] != b"\x7fELF":
+            raise ValueError("not an ELF file")
+        self.data = data
+        self.is64 = data[4] == 2
+        self.sections = []
+        if self.is64:
+            shoff, = struct.unpack_from("<Q", data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+        else:
+            shoff, = struct.unpack_from("<I", data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        headers = []
+        for i in range(shnum):
+            offset = shoff + i * shentsize
+            if self.is64:
+                name, kind, flags, addr, off, size = struct.unpack_from("<IIQQQQ", data, offset)
+            else:
+                name, kind, flags, addr, off, size = struct.unpack_from("<IIIIII", data, offset)
+            headers.append((name, kind, addr, off, size))
+        strtab = headers[shstrndx]
+        for name, kind, addr, off, size in headers:
+            end = data.index(b"\0", strtab[3] + name)
+            label = data[strtab[3] + name:end].decode()
+            # SHT_NOBITS sections have no bytes in the file.
+            contents = data[off:off + size] if kind != 8 else b""
+            self.sections.append((label, addr, contents))
+
+    def section(self, label):
+        for name, addr, contents in self.sections:
+            if name == label:
+                return addr, contents
+        return None
+
+    def string(self, address):
+        for name, addr, contents in self.sections:
+            if addr != 0 and addr <= address < addr + len(contents):
+                start = address - addr
+                end = contents.find(b"\0", start)
+                if end < 0:
+                    return None
+                return contents[start:end].decode(errors="replace")
+        return None
+
+
+def count_arguments(format):
+    return sum(1 for m in CONVERSION.finditer(format) if m.group(5) != "%")
+
+
+def render(elf, format, args):
+    args = list(args)
+
+    def convert(m):
+        flags, width, precision, _, kind = m.groups()
+        if kind == "%":
+            return "%"
+        value = args.pop(0)
+        if kind in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+        elif kind == "s":
+            string = elf.string(value)
+            if string is None:
+                return "<0x%08x>" % value
+            value = string
+        elif kind == "p":
+            return "0x%08x" % value
+        elif kind == "c":
+            value = chr(value & 0xff)
+        elif kind in "fFeEgG":
+            return "<float>"
+        spec = "%" + (flags or "") + (width or "") + ("." + precision if precision else "") + ("d" if kind == "u" else kind)
+        return spec % value
+
+    return CONVERSION.sub(convert, format)
+
+
+def decode(elf, stream, out):
+    section = elf.section(".os_log")
+    if section is None:
+        raise ValueError("no .os_log section, is os_log used?")
+    base, strings = section
+
+    offset = 0
+    while offset + 8 <= len(stream):
+        id, timestamp = struct.unpack_from("<II", stream, offset)
+        offset += 8
+        if not base <= id < base + len(strings):
+            out.write("unknown format 0x%08x at offset %d, giving up\n" % (id, offset - 8))
+            return False
+        end = strings.index(b"\0", id - base)
+        format = strings[id - base:end].decode(errors="replace")
+        nargs = count_arguments(format)
+        if offset + nargs * 4 > len(stream):
+            break
+        args = struct.unpack_from("<%dI" % nargs, stream, offset)
+        offset += nargs * 4
+        line = render(elf, format, args)
+        out.write("%10d.%06d %s%s" % (timestamp // 1000000, timestamp % 1000000, line, "" if line.endswith("\n") else "\n"))
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode os_log records using the firmware ELF.")
+    parser.add_argument("elf", help="firmware ELF with the .os_log section")
+    parser.add_argument("log", nargs="?", help="captured binary log, defaults to stdin")
+    options = parser.parse_args()
+
+    with open(options.elf, "rb") as f:
+        elf = Elf(f.read())
+
+    if options.log:
+        with open(options.log, "rb") as f:
+            stream = f.read()
+    else:
+        stream = sys.stdin.buffer.read()
+
+    return 0 if decode(elf, stream, sys.stdout) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())